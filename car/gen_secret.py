@@ -12,9 +12,110 @@
 #
 # @copyright Copyright (c) 2023 The MITRE Corporation
 
+import os
 import json
+import fcntl
+import tempfile
+import struct
 import argparse
 from pathlib import Path
+from secrets import token_bytes
+
+# Must match CAR_ID_SIZE and PASSWORD_SIZE in inc/board_link.h
+CAR_ID_SIZE = 8
+PASSWORD_SIZE = 16
+
+
+# @brief Zero pad a secret to its fixed size
+# @param data, bytes of the secret
+# @param size, fixed size of the secret in bytes
+def pad(data, size):
+    if len(data) > size:
+        raise ValueError(f"{data!r} does not fit in {size} bytes")
+    return data + b"\0" * (size - len(data))
+
+
+# @brief Format bytes as a C initializer of little-endian uint32_t words
+# @param data, bytes to format - length must be a multiple of 4
+def words_init(data):
+    words = struct.unpack(f"<{len(data) // 4}I", data)
+    return "{" + ", ".join(f"0x{w:08x}" for w in words) + "}"
+
+
+# @brief Replace a file's content only if it changed
+#
+# Leaves the file (and its mtime) alone when the content is the same, so make
+# sees no change. Otherwise writes a temp file and renames it into place, so
+# readers never see a partial file.
+# @param path, path of the file to write
+# @param text, new content of the file
+def write_if_changed(path, text):
+    if path.exists() and path.read_text() == text:
+        return
+
+    fd, tmp = tempfile.mkstemp(dir=path.parent, prefix=f".{path.name}.")
+    with os.fdopen(fd, "w") as fp:
+        fp.write(text)
+    os.chmod(tmp, 0o644)
+    os.replace(tmp, path)
+
+
+# @brief Load or create the secrets of one car
+#
+# Updates the secret file in place and returns the pre-derived values the
+# firmware needs. Shared with patch_secrets.py. The read-modify-write holds a
+# lock on <secret file>.lock, so concurrent car builds do not lose each
+# other's entries.
+# @param car_id, id of the car
+# @param secret_file, path of the JSON secret file
+def car_secrets(car_id, secret_file):
+    lock_file = secret_file.with_name(secret_file.name + ".lock")
+    with open(lock_file, "w") as lock:
+        fcntl.flock(lock, fcntl.LOCK_EX)
+        return update_car_secrets(car_id, secret_file)
+
+
+# @brief Body of car_secrets(), run with the secret file locked
+# @param car_id, id of the car
+# @param secret_file, path of the JSON secret file
+def update_car_secrets(car_id, secret_file):
+    # Open the secret file if it exists
+    if secret_file.exists():
+        with open(secret_file, "r") as fp:
+            secrets = json.load(fp)
+    else:
+        secrets = {}
+
+    # Add dummy secret
+    car_secret = car_id + 1
+    secrets[str(car_id)] = car_secret
+
+    # Per-car root key for session key derivation, kept stable across builds
+    session_keys = secrets.setdefault("session_keys", {})
+    if str(car_id) not in session_keys:
+        session_keys[str(car_id)] = os.urandom(16).hex()
+    session_key = bytes.fromhex(session_keys[str(car_id)])
+
+    # Random per-car unlock token sent by the fob and checked by the car,
+    # kept stable across builds - fob builds read it from here
+    passwords = secrets.setdefault("passwords", {})
+    if str(car_id) not in passwords:
+        passwords[str(car_id)] = token_bytes(PASSWORD_SIZE).hex()
+    password = bytes.fromhex(passwords[str(car_id)])
+
+    # Fixed-size form of the id
+    car_id_bytes = pad(str(car_id).encode(), CAR_ID_SIZE)
+
+    # Save the secret file - sorted keys make the content independent of the
+    # order cars were built in
+    write_if_changed(secret_file, json.dumps(secrets, indent=4, sort_keys=True))
+
+    return {
+        "car_secret": car_secret,
+        "car_id": car_id_bytes,
+        "password": password,
+        "session_root_key": session_key,
+    }
 
 
 def main():
@@ -24,29 +125,20 @@ def main():
     parser.add_argument("--header-file", type=Path, required=True)
     args = parser.parse_args()
 
-    # Open the secret file if it exists
-    if args.secret_file.exists():
-        with open(args.secret_file, "r") as fp:
-            secrets = json.load(fp)
-    else:
-        secrets = {}
+    secrets = car_secrets(args.car_id, args.secret_file)
+    session_key_init = ", ".join(f"0x{b:02x}" for b in secrets["session_root_key"])
 
-    # Add dummy secret
-    car_secret = args.car_id + 1
-    secrets[str(args.car_id)] = car_secret
-
-    # Save the secret file
-    with open(args.secret_file, "w") as fp:
-        json.dump(secrets, fp, indent=4)
-
-    # Write to header file
-    with open(args.header_file, "w") as fp:
-        fp.write("#ifndef __CAR_SECRETS__\n")
-        fp.write("#define __CAR_SECRETS__\n\n")
-        fp.write(f"#define CAR_SECRET {car_secret}\n\n")
-        fp.write(f'#define CAR_ID "{args.car_id}"\n\n')
-        fp.write('#define PASSWORD "unlock"\n\n')
-        fp.write("#endif\n")
+    # Write to header file - untouched if the secrets did not change
+    write_if_changed(
+        args.header_file,
+        "#ifndef __CAR_SECRETS__\n"
+        "#define __CAR_SECRETS__\n\n"
+        f"#define CAR_SECRET {secrets['car_secret']}\n\n"
+        f"#define CAR_ID {words_init(secrets['car_id'])}\n\n"
+        f"#define PASSWORD {words_init(secrets['password'])}\n\n"
+        f"#define SESSION_ROOT_KEY {{{session_key_init}}}\n\n"
+        "#endif\n",
+    )
 
 
 if __name__ == "__main__":
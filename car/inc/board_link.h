@@ -15,6 +15,7 @@
 #ifndef BOARD_LINK_H
 #define BOARD_LINK_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "inc/hw_memmap.h"
@@ -28,6 +29,19 @@
 #define START_MAGIC 0x57
 #define BOARD_UART ((uint32_t)UART1_BASE)
 
+// Sizes of the fixed-size secrets generated by gen_secret.py, all multiples
+// of a word so they can be compared a word at a time
+#define CAR_ID_SIZE 8
+#define PASSWORD_SIZE 16
+#define PAIR_PIN_SIZE 8
+
+// Message buffers hold the largest payload (message_len is one byte) and are
+// word aligned so payloads can be viewed as packet structs
+#define MESSAGE_BUFFER_SIZE 256
+
+// Buffers in the message pool - startCar holds its message and one EEPROM block
+#define MESSAGE_POOL_SIZE 2
+
 /**
  * @brief Structure for message between boards
  *
@@ -42,10 +56,20 @@ typedef struct
 /**
  * @brief Set the up board link object
  *
- * UART 1 is used to communicate between boards
+ * UART 1 is used to communicate between boards. UART 1 and GPIO Port B must
+ * already be enabled. Received bytes are moved into a ring buffer from the
+ * UART interrupt, so they are not lost while the main loop is busy; this
+ * enables interrupts.
  */
 void setup_board_link(void);
 
+/**
+ * @brief Check whether board link data is waiting to be received
+ *
+ * @return true if a receive would not wait
+ */
+bool board_link_avail(void);
+
 /**
  * @brief Send a message between boards
  *
@@ -71,4 +95,22 @@ uint32_t receive_board_message(MESSAGE_PACKET *message);
  */
 uint32_t receive_board_message_by_type(MESSAGE_PACKET *message, uint8_t type);
 
+/**
+ * @brief Take a buffer from the message pool
+ *
+ * Not safe to call from interrupt handlers. The pool is sized for the
+ * firmware's own callers, so running out is a bug: it raises a fault
+ * (FaultISR) instead of returning NULL.
+ *
+ * @return uint8_t* a MESSAGE_BUFFER_SIZE buffer
+ */
+uint8_t *message_buffer_alloc(void);
+
+/**
+ * @brief Return a buffer to the message pool
+ *
+ * @param buffer buffer returned by message_buffer_alloc()
+ */
+void message_buffer_release(uint8_t *buffer);
+
 #endif
@@ -0,0 +1,38 @@
+/**
+ * @file drbg.h
+ * @brief AES-128 CTR-DRBG used to generate nonces
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef DRBG_H
+#define DRBG_H
+
+#include <stdint.h>
+
+#define DRBG_NONCE_SIZE 16
+
+/**
+ * @brief Instantiate the DRBG from the entropy pool
+ *
+ * entropy_init() must have been called first.
+ */
+void drbg_init(void);
+
+/**
+ * @brief Generate a fresh nonce
+ *
+ * Every call performs the same fixed sequence of operations, so the cost of
+ * a nonce is constant and never waits on an entropy source.
+ *
+ * @param nonce pointer to DRBG_NONCE_SIZE bytes of output
+ */
+void drbg_generate_nonce(uint8_t *nonce);
+
+#endif
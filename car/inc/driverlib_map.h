@@ -0,0 +1,29 @@
+/**
+ * @file driverlib_map.h
+ * @brief Selects the ROM or flash copy of driverlib for MAP_ calls
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef DRIVERLIB_MAP_H
+#define DRIVERLIB_MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// With ROM_DRIVERLIB (see the Makefile) rom.h defines ROM_ calls into the
+// on-chip ROM for TARGET_IS_TM4C123_RB1, and rom_map.h maps each MAP_ call to
+// its ROM_ version where one exists. Otherwise every MAP_ call goes to the
+// copy of driverlib linked from libdriver.a.
+#ifdef ROM_DRIVERLIB
+#include "driverlib/rom.h"
+#endif
+#include "driverlib/rom_map.h"
+
+#endif
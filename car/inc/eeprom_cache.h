@@ -0,0 +1,49 @@
+/**
+ * @file eeprom_cache.h
+ * @brief Lazy EEPROM initialization and RAM cache of the unlock data
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef EEPROM_CACHE_H
+#define EEPROM_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Advance EEPROM initialization and cache warm-up by one step
+ *
+ * Call repeatedly while idle. Waits for nothing except EEPROMInit itself,
+ * which only takes long when it has to recover from an interrupted write:
+ * the first steps run it once the EEPROM has powered up, later steps copy
+ * the feature and unlock messages into RAM a block at a time. The EEPROM
+ * peripheral must already be enabled.
+ */
+void eeprom_cache_poll(void);
+
+/**
+ * @brief Check whether the EEPROM is initialized and the cache is full
+ *
+ * @return true once eeprom_cache_poll() has nothing left to do
+ */
+bool eeprom_cache_ready(void);
+
+/**
+ * @brief Read from the EEPROM, through the cache where possible
+ *
+ * Finishes any initialization and warm-up left first.
+ *
+ * @param data pointer to the destination, word aligned
+ * @param address EEPROM byte address, a multiple of 4
+ * @param count number of bytes to read, a multiple of 4
+ */
+void eeprom_cache_read(uint32_t *data, uint32_t address, uint32_t count);
+
+#endif
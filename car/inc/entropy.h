@@ -0,0 +1,58 @@
+/**
+ * @file entropy.h
+ * @brief Entropy pool fed by ADC noise and clock jitter
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef ENTROPY_H
+#define ENTROPY_H
+
+#include <stdint.h>
+
+#define ENTROPY_SEED_SIZE 32
+
+/**
+ * @brief Initialize the entropy sources and fill the pool
+ *
+ * Enables ADC0 (internal temperature sensor), a PIOSC-clocked timer and
+ * SysTick, then harvests a fixed number of samples into the pool. SysTick
+ * only adds oscillator jitter once the system clock runs from the main
+ * crystal rather than the PIOSC. This is the only place that waits on the
+ * hardware, so call it once at boot.
+ */
+void entropy_init(void);
+
+/**
+ * @brief Opportunistically mix new samples into the pool
+ *
+ * Never blocks: collects the ADC result if a conversion has finished, starts
+ * the next one and mixes in a snapshot of both free-running clocks.
+ */
+void entropy_poll(void);
+
+/**
+ * @brief Mix caller supplied data into the pool
+ *
+ * @param data pointer to the data to mix in
+ * @param len number of bytes to mix in
+ */
+void entropy_add(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Derive seed material from the pool
+ *
+ * Runs in a fixed number of block cipher operations regardless of how much
+ * has been mixed in, and ratchets the pool forward afterwards.
+ *
+ * @param seed pointer to ENTROPY_SEED_SIZE bytes of output
+ */
+void entropy_extract(uint8_t *seed);
+
+#endif
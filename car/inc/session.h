@@ -0,0 +1,67 @@
+/**
+ * @file session.h
+ * @brief Per-unlock session keys and streaming authenticated encryption
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdint.h>
+
+#define SESSION_NONCE_SIZE 16
+#define SESSION_TAG_SIZE 16
+
+/**
+ * @brief Derive the session keys for one transaction
+ *
+ * HKDF-style extract-and-expand with AES-CMAC as the PRF: the nonce salts
+ * the extraction from the car's root key, and the expansion yields one
+ * encryption key and one MAC key. Both key schedules are set up here, once
+ * per transaction, and the nonce is bound into the MAC.
+ *
+ * @param nonce pointer to SESSION_NONCE_SIZE bytes, fresh for every session
+ */
+void session_begin(const uint8_t *nonce);
+
+/**
+ * @brief Absorb data sent in the clear into the MAC
+ *
+ * For the framing headers of the response: they stay readable so the
+ * receiver can find the end of the response, but a changed header (such as
+ * the feature count) fails the tag. The MAC covers clear and encrypted data
+ * in the order of the calls.
+ *
+ * @param buf pointer to the data
+ * @param len number of bytes
+ */
+void session_authenticate(const uint8_t *buf, uint32_t len);
+
+/**
+ * @brief Encrypt part of the response in place and absorb it into the MAC
+ *
+ * May be called any number of times. The MAC continues where the previous
+ * call stopped; the keystream continues at the next unused counter block,
+ * so the receiver must split the stream at the same boundaries (the feature
+ * and unlock messages are whole blocks, so this never matters in practice).
+ *
+ * @param buf pointer to the data to encrypt
+ * @param len number of bytes to encrypt
+ */
+void session_encrypt(uint8_t *buf, uint32_t len);
+
+/**
+ * @brief Finalize the MAC over everything encrypted and wipe the keys
+ *
+ * @param tag pointer to SESSION_TAG_SIZE bytes of output
+ */
+void session_finish(uint8_t *tag);
+
+#endif
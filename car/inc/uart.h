@@ -25,7 +25,8 @@
 /**
  * @brief Initialize the UART interfaces.
  *
- * UART 0 is used to communicate with the door/fob.
+ * UART 0 is used to communicate with the door/fob. UART 0 and GPIO Port A
+ * must already be enabled.
  */
 void uart_init(void);
 
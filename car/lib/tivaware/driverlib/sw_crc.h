@@ -65,6 +65,41 @@ extern void Crc16Array3(uint32_t ui32WordLen, const uint32_t *pui32Data,
                         uint16_t *pui16Crc3);
 extern uint32_t Crc32(uint32_t ui32Crc, const uint8_t *pui8Data,
                       uint32_t ui32Count);
+extern uint16_t Crc16Slice4(uint16_t ui16Crc, const uint8_t *pui8Data,
+                            uint32_t ui32Count);
+extern uint16_t Crc16Slice8(uint16_t ui16Crc, const uint8_t *pui8Data,
+                            uint32_t ui32Count);
+extern uint32_t Crc32Slice4(uint32_t ui32Crc, const uint8_t *pui8Data,
+                            uint32_t ui32Count);
+extern uint32_t Crc32Slice8(uint32_t ui32Crc, const uint8_t *pui8Data,
+                            uint32_t ui32Count);
+
+//*****************************************************************************
+//
+// Crc16Fast() and Crc32Fast() map onto the CRC kernel selected at compile
+// time by SW_CRC_SLICE_BY: 1 for the byte-wise Crc16()/Crc32() (smallest
+// flash footprint), 4 for the slice-by-4 kernels or 8 for the slice-by-8
+// kernels.  Either sliced variant pulls in an extra 3.5 KB (CRC-16) or 7 KB
+// (CRC-32) of tables.  All kernels produce bit-identical results, and unused
+// kernels and their tables are discarded by the linker.
+//
+//*****************************************************************************
+#ifndef SW_CRC_SLICE_BY
+#define SW_CRC_SLICE_BY         8
+#endif
+
+#if SW_CRC_SLICE_BY == 1
+#define Crc16Fast               Crc16
+#define Crc32Fast               Crc32
+#elif SW_CRC_SLICE_BY == 4
+#define Crc16Fast               Crc16Slice4
+#define Crc32Fast               Crc32Slice4
+#elif SW_CRC_SLICE_BY == 8
+#define Crc16Fast               Crc16Slice8
+#define Crc32Fast               Crc32Slice8
+#else
+#error "SW_CRC_SLICE_BY must be 1, 4 or 8"
+#endif
 
 //*****************************************************************************
 //
@@ -0,0 +1,97 @@
+#!/usr/bin/python3 -u
+
+# @file patch_secrets
+# @brief Stamp a car's secrets into a prebuilt firmware image
+# @date 2023
+#
+# This source file is part of an example system for MITRE's 2023 Embedded CTF (eCTF).
+# This code is being provided only for educational purposes for the 2023 MITRE eCTF
+# competition,and may not meet MITRE standards for quality. Use this code at your
+# own risk!
+#
+# @copyright Copyright (c) 2023 The MITRE Corporation
+
+import struct
+import argparse
+from pathlib import Path
+
+from gen_secret import car_secrets
+
+# Must match firmware.ld and inc/device_secrets.h
+FLASH_BASE = 0x00008000
+SECRETS_ADDR = 0x00008400
+SECRETS_MAGIC = 0x52434553
+
+
+# @brief Pack the secrets block in the layout of DEVICE_SECRETS
+# @param secrets, values returned by car_secrets()
+def pack_block(secrets):
+    return (
+        struct.pack("<I", SECRETS_MAGIC)
+        + secrets["car_id"]
+        + secrets["password"]
+        + secrets["session_root_key"]
+    )
+
+
+# @brief Find the file offset and size of the .secrets section of an ELF image
+# @param elf, bytes of a little-endian ELF32 image
+def elf_secrets_offset(elf):
+    if elf[:6] != b"\x7fELF\x01\x01":
+        raise ValueError("not a little-endian ELF32 image")
+
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+    strtab_offset = struct.unpack_from("<10I", elf, shoff + shstrndx * shentsize)[4]
+
+    for i in range(shnum):
+        name, _, _, addr, offset, size = struct.unpack_from(
+            "<6I", elf, shoff + i * shentsize
+        )
+        end = elf.index(b"\0", strtab_offset + name)
+        if elf[strtab_offset + name : end] == b".secrets":
+            if addr != SECRETS_ADDR:
+                raise ValueError(f".secrets is at 0x{addr:08x}, not SECRETS_ADDR")
+            return offset, size
+
+    raise ValueError("no .secrets section")
+
+
+# @brief Replace the secrets block at an offset after checking its magic
+# @param image, bytearray of the image to patch
+# @param offset, offset of the secrets block in the image
+# @param size, size of the secrets block in the image
+# @param block, packed secrets block
+def patch(image, offset, size, block):
+    magic, = struct.unpack_from("<I", image, offset)
+    if magic != SECRETS_MAGIC or size != len(block):
+        raise ValueError("image does not match this secrets block layout")
+    image[offset : offset + size] = block
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--car-id", type=int, required=True)
+    parser.add_argument("--secret-file", type=Path, required=True)
+    parser.add_argument("--in-bin", type=Path, required=True)
+    parser.add_argument("--in-elf", type=Path, required=True)
+    parser.add_argument("--bin-path", type=Path, required=True)
+    parser.add_argument("--elf-path", type=Path, required=True)
+    args = parser.parse_args()
+
+    block = pack_block(car_secrets(args.car_id, args.secret_file))
+
+    # The raw image starts at the flash base; there is no image checksum, so
+    # replacing the block is the whole transform
+    image = bytearray(args.in_bin.read_bytes())
+    patch(image, SECRETS_ADDR - FLASH_BASE, len(block), block)
+    args.bin_path.write_bytes(image)
+
+    elf = bytearray(args.in_elf.read_bytes())
+    offset, size = elf_secrets_offset(elf)
+    patch(elf, offset, size, block)
+    args.elf_path.write_bytes(elf)
+
+
+if __name__ == "__main__":
+    main()
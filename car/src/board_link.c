@@ -13,6 +13,7 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "inc/hw_memmap.h"
@@ -21,35 +22,100 @@
 
 #include "driverlib/gpio.h"
 #include "driverlib/pin_map.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
 
 #include "board_link.h"
+#include "driverlib_map.h"
+
+// Fixed pool of message buffers and which of them are handed out
+static uint8_t message_pool[MESSAGE_POOL_SIZE][MESSAGE_BUFFER_SIZE]
+    __attribute__((aligned(4)));
+static bool message_used[MESSAGE_POOL_SIZE];
+
+// Receive ring filled by board_link_isr - a power of two with room for the
+// one message the fob can have in flight while the car is busy
+#define BOARD_RX_SIZE 512
+static volatile uint8_t rx_ring[BOARD_RX_SIZE];
+static volatile uint32_t rx_head; // advanced by board_link_isr only
+static uint32_t rx_tail;          // advanced by the readers only
+
+/**
+ * @brief Interrupt handler for the board link UART
+ *
+ * Moves every received byte into the ring, so the 16 byte receive FIFO
+ * cannot overrun while the main loop is blocked (EEPROM recovery in
+ * eeprom_cache_poll, for one). Bytes that find the ring full are dropped.
+ */
+static void board_link_isr(void) {
+  MAP_UARTIntClear(BOARD_UART, MAP_UARTIntStatus(BOARD_UART, true));
+
+  while (MAP_UARTCharsAvail(BOARD_UART)) {
+    uint8_t c = (uint8_t)MAP_UARTCharGetNonBlocking(BOARD_UART);
+
+    if (rx_head - rx_tail < BOARD_RX_SIZE) {
+      rx_ring[rx_head % BOARD_RX_SIZE] = c;
+      rx_head++;
+    }
+  }
+}
+
+/**
+ * @brief Take the next received byte, waiting for one if the ring is empty
+ *
+ * @return uint8_t the byte
+ */
+static uint8_t board_link_readb(void) {
+  uint8_t c;
+
+  while (rx_head == rx_tail) {
+  }
+  c = rx_ring[rx_tail % BOARD_RX_SIZE];
+  rx_tail++;
+
+  return c;
+}
 
 /**
  * @brief Set the up board link object
  *
- * UART 1 is used to communicate between boards
+ * UART 1 is used to communicate between boards. UART 1 and GPIO Port B must
+ * already be enabled.
  */
 void setup_board_link(void) {
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+  while (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_UART1) ||
+         !MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOB)) {
+  }
 
-  GPIOPinConfigure(GPIO_PB0_U1RX);
-  GPIOPinConfigure(GPIO_PB1_U1TX);
+  MAP_GPIOPinConfigure(GPIO_PB0_U1RX);
+  MAP_GPIOPinConfigure(GPIO_PB1_U1TX);
 
-  GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+  MAP_GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
 
   // Configure the UART for 115,200, 8-N-1 operation.
-  UARTConfigSetExpClk(
-      BOARD_UART, SysCtlClockGet(), 115200,
+  MAP_UARTConfigSetExpClk(
+      BOARD_UART, MAP_SysCtlClockGet(), 115200,
       (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
 
-  while (UARTCharsAvail(BOARD_UART)) {
-    UARTCharGet(BOARD_UART);
+  while (MAP_UARTCharsAvail(BOARD_UART)) {
+    MAP_UARTCharGet(BOARD_UART);
   }
+
+  // Receive through the ring - the receive timeout interrupt covers bytes
+  // left below the FIFO trigger level
+  UARTIntRegister(BOARD_UART, board_link_isr);
+  MAP_UARTIntEnable(BOARD_UART, UART_INT_RX | UART_INT_RT);
+  MAP_IntMasterEnable();
 }
 
+/**
+ * @brief Check whether board link data is waiting to be received
+ *
+ * @return true if a receive would not wait
+ */
+bool board_link_avail(void) { return rx_head != rx_tail; }
+
 /**
  * @brief Send a message between boards
  *
@@ -57,11 +123,11 @@ void setup_board_link(void) {
  * @return uint32_t the number of bytes sent
  */
 uint32_t send_board_message(MESSAGE_PACKET *message) {
-  UARTCharPut(BOARD_UART, message->magic);
-  UARTCharPut(BOARD_UART, message->message_len);
+  MAP_UARTCharPut(BOARD_UART, message->magic);
+  MAP_UARTCharPut(BOARD_UART, message->message_len);
 
   for (int i = 0; i < message->message_len; i++) {
-    UARTCharPut(BOARD_UART, message->buffer[i]);
+    MAP_UARTCharPut(BOARD_UART, message->buffer[i]);
   }
 
   return message->message_len;
@@ -74,16 +140,16 @@ uint32_t send_board_message(MESSAGE_PACKET *message) {
  * @return uint32_t the number of bytes received - 0 for error
  */
 uint32_t receive_board_message(MESSAGE_PACKET *message) {
-  message->magic = (uint8_t)UARTCharGet(BOARD_UART);
+  message->magic = board_link_readb();
 
   if (message->magic == 0) {
     return 0;
   }
 
-  message->message_len = (uint8_t)UARTCharGet(BOARD_UART);
+  message->message_len = board_link_readb();
 
   for (int i = 0; i < message->message_len; i++) {
-    message->buffer[i] = (uint8_t)UARTCharGet(BOARD_UART);
+    message->buffer[i] = board_link_readb();
   }
 
   return message->message_len;
@@ -103,3 +169,30 @@ uint32_t receive_board_message_by_type(MESSAGE_PACKET *message, uint8_t type) {
 
   return message->message_len;
 }
+
+/**
+ * @brief Take a buffer from the message pool
+ *
+ * @return uint8_t* a MESSAGE_BUFFER_SIZE buffer
+ */
+uint8_t *message_buffer_alloc(void) {
+  for (int i = 0; i < MESSAGE_POOL_SIZE; i++) {
+    if (!message_used[i]) {
+      message_used[i] = true;
+      return message_pool[i];
+    }
+  }
+
+  // MESSAGE_POOL_SIZE is too small for the callers - a leak or a new
+  // caller. Fault rather than hand out NULL to be written through.
+  __builtin_trap();
+}
+
+/**
+ * @brief Return a buffer to the message pool
+ *
+ * @param buffer buffer returned by message_buffer_alloc()
+ */
+void message_buffer_release(uint8_t *buffer) {
+  message_used[(buffer - message_pool[0]) / MESSAGE_BUFFER_SIZE] = false;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file ct_util.c
+ * @brief Constant-time comparison, copy and zeroize helpers for secrets
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <stdint.h>
+
+#include "ct_util.h"
+
+// Keeps the compiler from reasoning about (and short-circuiting on) a value
+#define CT_BARRIER(x) __asm__ volatile("" : "+r"(x))
+
+// Both pointers word-aligned
+#define CT_ALIGNED(a, b) (((uint32_t)(a) | (uint32_t)(b)) % sizeof(uint32_t) == 0)
+
+/**
+ * @brief Compare two buffers in time that depends only on the length
+ *
+ * @param a pointer to the first buffer
+ * @param b pointer to the second buffer
+ * @param len number of bytes to compare
+ * @return uint32_t 0 if the buffers are equal, 1 otherwise
+ */
+RAMFUNC uint32_t ct_compare(const void *a, const void *b, uint32_t len) {
+  const uint8_t *pa = a;
+  const uint8_t *pb = b;
+  uint32_t diff = 0;
+
+  if (CT_ALIGNED(pa, pb)) {
+    for (; len >= sizeof(uint32_t); len -= sizeof(uint32_t)) {
+      diff |= *(const uint32_t *)pa ^ *(const uint32_t *)pb;
+      CT_BARRIER(diff);
+      pa += sizeof(uint32_t);
+      pb += sizeof(uint32_t);
+    }
+  }
+
+  for (; len > 0; len--) {
+    diff |= *pa++ ^ *pb++;
+    CT_BARRIER(diff);
+  }
+
+  // Collapse to 0/1 without a branch
+  return (diff | (0 - diff)) >> 31;
+}
+
+/**
+ * @brief Copy a buffer in time that depends only on the length
+ *
+ * @param dst pointer to the destination buffer
+ * @param src pointer to the source buffer
+ * @param len number of bytes to copy
+ */
+RAMFUNC void ct_copy(void *dst, const void *src, uint32_t len) {
+  uint8_t *pd = dst;
+  const uint8_t *ps = src;
+
+  if (CT_ALIGNED(pd, ps)) {
+    for (; len >= sizeof(uint32_t); len -= sizeof(uint32_t)) {
+      *(uint32_t *)pd = *(const uint32_t *)ps;
+      pd += sizeof(uint32_t);
+      ps += sizeof(uint32_t);
+    }
+  }
+
+  for (; len > 0; len--) {
+    *pd++ = *ps++;
+  }
+}
+
+/**
+ * @brief Clear a buffer in a way the compiler cannot optimize out
+ *
+ * @param buf pointer to the buffer to clear
+ * @param len number of bytes to clear
+ */
+RAMFUNC void ct_zeroize(void *buf, uint32_t len) {
+  volatile uint8_t *p = buf;
+
+  if (CT_ALIGNED(p, 0)) {
+    for (; len >= sizeof(uint32_t); len -= sizeof(uint32_t)) {
+      *(volatile uint32_t *)p = 0;
+      p += sizeof(uint32_t);
+    }
+  }
+
+  for (; len > 0; len--) {
+    *p++ = 0;
+  }
+}
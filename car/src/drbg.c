@@ -0,0 +1,117 @@
+/**
+ * @file drbg.c
+ * @brief AES-128 CTR-DRBG used to generate nonces
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "aes.h"
+
+#include "ct_util.h"
+#include "drbg.h"
+#include "entropy.h"
+
+// CTR-DRBG (NIST SP 800-90A) with AES-128 and no derivation function: the
+// seed length is one key plus one block
+#define DRBG_SEED_SIZE (AES_KEYLEN + AES_BLOCKLEN)
+
+#if DRBG_SEED_SIZE != ENTROPY_SEED_SIZE
+#error "Entropy pool output must match the DRBG seed length"
+#endif
+
+/*** Structure definitions ***/
+// Working state of the DRBG - key schedule and counter block
+typedef struct {
+  struct AES_ctx ctx;
+  uint8_t v[AES_BLOCKLEN];
+} DRBG_STATE;
+
+static DRBG_STATE drbg;
+
+/**
+ * @brief Increment the 128-bit big-endian counter V
+ *
+ * Always touches all 16 bytes so the run time does not depend on V.
+ */
+static void drbg_increment(void) {
+  uint32_t carry = 1;
+
+  for (int i = AES_BLOCKLEN - 1; i >= 0; i--) {
+    carry += drbg.v[i];
+    drbg.v[i] = (uint8_t)carry;
+    carry >>= 8;
+  }
+}
+
+/**
+ * @brief CTR_DRBG_Update - derive a new key and V from the old state
+ *
+ * @param provided_data DRBG_SEED_SIZE bytes to mix in
+ */
+static void drbg_update(const uint8_t *provided_data) {
+  uint8_t temp[DRBG_SEED_SIZE];
+
+  for (int i = 0; i < DRBG_SEED_SIZE; i += AES_BLOCKLEN) {
+    drbg_increment();
+    memcpy(&temp[i], drbg.v, AES_BLOCKLEN);
+    AES_ECB_encrypt(&drbg.ctx, &temp[i]);
+  }
+
+  for (int i = 0; i < DRBG_SEED_SIZE; i++) {
+    temp[i] ^= provided_data[i];
+  }
+
+  AES_init_ctx(&drbg.ctx, temp);
+  memcpy(drbg.v, &temp[AES_KEYLEN], AES_BLOCKLEN);
+
+  ct_zeroize(temp, sizeof(temp));
+}
+
+/**
+ * @brief Instantiate the DRBG from the entropy pool
+ */
+void drbg_init(void) {
+  uint8_t seed[ENTROPY_SEED_SIZE];
+  uint8_t zero_key[AES_KEYLEN] = {0};
+
+  memset(drbg.v, 0, sizeof(drbg.v));
+  AES_init_ctx(&drbg.ctx, zero_key);
+
+  entropy_extract(seed);
+  drbg_update(seed);
+
+  ct_zeroize(seed, sizeof(seed));
+}
+
+/**
+ * @brief Generate a fresh nonce
+ *
+ * Fresh pool output is passed as additional input on every call instead of
+ * counting requests towards a reseed, so every nonce costs the same: one
+ * pool extraction, two updates and one output block.
+ *
+ * @param nonce pointer to DRBG_NONCE_SIZE bytes of output
+ */
+void drbg_generate_nonce(uint8_t *nonce) {
+  uint8_t additional_input[ENTROPY_SEED_SIZE];
+
+  entropy_extract(additional_input);
+  drbg_update(additional_input);
+
+  drbg_increment();
+  memcpy(nonce, drbg.v, DRBG_NONCE_SIZE);
+  AES_ECB_encrypt(&drbg.ctx, nonce);
+
+  drbg_update(additional_input);
+
+  ct_zeroize(additional_input, sizeof(additional_input));
+}
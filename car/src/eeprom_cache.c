@@ -0,0 +1,98 @@
+/**
+ * @file eeprom_cache.c
+ * @brief Lazy EEPROM initialization and RAM cache of the unlock data
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/hw_eeprom.h"
+#include "inc/hw_types.h"
+
+#include "driverlib/eeprom.h"
+#include "driverlib/sysctl.h"
+
+#include "driverlib_map.h"
+#include "eeprom_cache.h"
+#include "feature_list.h"
+
+// The feature messages sit just below FEATURE_END and the unlock message
+// (UNLOCK_EEPROM_LOC in firmware.c) at FEATURE_END - cache all of them
+#define CACHE_START (FEATURE_END - NUM_FEATURES * FEATURE_SIZE)
+#define CACHE_END (FEATURE_END + FEATURE_SIZE)
+#define CACHE_BLOCK FEATURE_SIZE
+
+typedef enum {
+  CACHE_POWERUP, // waiting for the EEPROM to finish powering up
+  CACHE_WARM,    // copying the next block into the cache
+  CACHE_READY,   // everything cached
+} CACHE_STATE;
+
+static CACHE_STATE state = CACHE_POWERUP;
+static uint32_t warm_address = CACHE_START;
+static uint32_t cache[(CACHE_END - CACHE_START) / sizeof(uint32_t)];
+
+/**
+ * @brief Advance EEPROM initialization and cache warm-up by one step
+ */
+void eeprom_cache_poll(void) {
+  switch (state) {
+  case CACHE_POWERUP:
+    // EEPROMInit would spin on both of these - only call it once they are
+    // done, leaving just its own reset and any write recovery
+    if (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_EEPROM0) ||
+        (HWREG(EEPROM_EEDONE) & EEPROM_EEDONE_WORKING)) {
+      return;
+    }
+    MAP_EEPROMInit();
+    state = CACHE_WARM;
+    break;
+
+  case CACHE_WARM:
+    MAP_EEPROMRead(&cache[(warm_address - CACHE_START) / sizeof(uint32_t)],
+                   warm_address, CACHE_BLOCK);
+    warm_address += CACHE_BLOCK;
+    if (warm_address == CACHE_END) {
+      state = CACHE_READY;
+    }
+    break;
+
+  case CACHE_READY:
+    break;
+  }
+}
+
+/**
+ * @brief Check whether the EEPROM is initialized and the cache is full
+ *
+ * @return true once eeprom_cache_poll() has nothing left to do
+ */
+bool eeprom_cache_ready(void) { return state == CACHE_READY; }
+
+/**
+ * @brief Read from the EEPROM, through the cache where possible
+ *
+ * @param data pointer to the destination, word aligned
+ * @param address EEPROM byte address, a multiple of 4
+ * @param count number of bytes to read, a multiple of 4
+ */
+void eeprom_cache_read(uint32_t *data, uint32_t address, uint32_t count) {
+  while (!eeprom_cache_ready()) {
+    eeprom_cache_poll();
+  }
+
+  if (address >= CACHE_START && address + count <= CACHE_END) {
+    memcpy(data, &cache[(address - CACHE_START) / sizeof(uint32_t)], count);
+  } else {
+    MAP_EEPROMRead(data, address, count);
+  }
+}
@@ -0,0 +1,189 @@
+/**
+ * @file entropy.c
+ * @brief Entropy pool fed by ADC noise and clock jitter
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+
+#include "driverlib/adc.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "driverlib/timer.h"
+
+#include "aes.h"
+
+#include "driverlib_map.h"
+#include "entropy.h"
+
+// Number of samples harvested at boot - sized for the ADC noise alone, the
+// clock phase is mixed in but not counted on
+#define ENTROPY_BOOT_SAMPLES 128
+
+// ADC sequencer used for sampling the temperature sensor
+#define ENTROPY_ADC_SEQ 3
+
+// Timer clocked from the PIOSC, sampled against SysTick, which runs from the
+// system clock - the PLL on the main crystal, set up by main()
+#define ENTROPY_TIMER_BASE TIMER0_BASE
+
+// Fixed key used only to condition raw samples, not a secret
+static const uint8_t condition_key[AES_KEYLEN] = {
+    0x45, 0x43, 0x54, 0x46, 0x2d, 0x65, 0x6e, 0x74,
+    0x72, 0x6f, 0x70, 0x79, 0x2d, 0x70, 0x6f, 0x6f};
+
+static struct AES_ctx condition_ctx;
+
+// Conditioned pool state and the partially filled input block
+static uint8_t pool[AES_BLOCKLEN];
+static uint8_t pending[AES_BLOCKLEN];
+static uint32_t pending_len;
+static uint32_t extract_count;
+
+/**
+ * @brief Fold the pending input block into the pool
+ */
+static void entropy_fold(void) {
+  for (int i = 0; i < AES_BLOCKLEN; i++) {
+    pool[i] ^= pending[i];
+  }
+  AES_ECB_encrypt(&condition_ctx, pool);
+
+  memset(pending, 0, sizeof(pending));
+  pending_len = 0;
+}
+
+/**
+ * @brief Take one raw sample of both clocks and the given ADC reading
+ *
+ * The ADC low bits carry thermal noise. The timer runs from the PIOSC and
+ * SysTick from the crystal through the PLL, so their relative phase drifts
+ * with the jitter between two independent oscillators. How much that drift
+ * holds is unknown, so the boot harvest does not count on it.
+ *
+ * @param adc_value most recent ADC reading
+ */
+static void entropy_add_sample(uint32_t adc_value) {
+  uint32_t sample[2];
+
+  sample[0] =
+      MAP_TimerValueGet(ENTROPY_TIMER_BASE, TIMER_A) ^ (adc_value << 20);
+  sample[1] = MAP_SysTickValueGet() ^ (adc_value << 24);
+
+  entropy_add((uint8_t *)sample, sizeof(sample));
+}
+
+/**
+ * @brief Initialize the entropy sources and fill the pool
+ */
+void entropy_init(void) {
+  uint32_t adc_value;
+
+  AES_init_ctx(&condition_ctx, condition_key);
+
+  // SysTick free-runs from the system clock
+  MAP_SysTickPeriodSet(0x01000000);
+  MAP_SysTickEnable();
+
+  // Full width periodic timer clocked from the PIOSC
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+  while (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER0) ||
+         !MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_ADC0)) {
+  }
+
+  MAP_TimerClockSourceSet(ENTROPY_TIMER_BASE, TIMER_CLOCK_PIOSC);
+  MAP_TimerConfigure(ENTROPY_TIMER_BASE, TIMER_CFG_PERIODIC);
+  MAP_TimerLoadSet(ENTROPY_TIMER_BASE, TIMER_A, 0xFFFFFFFF);
+  MAP_TimerEnable(ENTROPY_TIMER_BASE, TIMER_A);
+
+  // Single conversion of the internal temperature sensor per trigger
+  MAP_ADCSequenceConfigure(ADC0_BASE, ENTROPY_ADC_SEQ, ADC_TRIGGER_PROCESSOR,
+                           0);
+  MAP_ADCSequenceStepConfigure(ADC0_BASE, ENTROPY_ADC_SEQ, 0,
+                           ADC_CTL_TS | ADC_CTL_IE | ADC_CTL_END);
+  MAP_ADCSequenceEnable(ADC0_BASE, ENTROPY_ADC_SEQ);
+  MAP_ADCIntClear(ADC0_BASE, ENTROPY_ADC_SEQ);
+
+  // Boot harvest - the only place that waits on a conversion
+  for (int i = 0; i < ENTROPY_BOOT_SAMPLES; i++) {
+    MAP_ADCProcessorTrigger(ADC0_BASE, ENTROPY_ADC_SEQ);
+    while (!MAP_ADCIntStatus(ADC0_BASE, ENTROPY_ADC_SEQ, false)) {
+    }
+    MAP_ADCIntClear(ADC0_BASE, ENTROPY_ADC_SEQ);
+    MAP_ADCSequenceDataGet(ADC0_BASE, ENTROPY_ADC_SEQ, &adc_value);
+
+    entropy_add_sample(adc_value);
+  }
+  entropy_fold();
+
+  // Leave a conversion in flight for the first entropy_poll()
+  MAP_ADCProcessorTrigger(ADC0_BASE, ENTROPY_ADC_SEQ);
+}
+
+/**
+ * @brief Opportunistically mix new samples into the pool
+ */
+void entropy_poll(void) {
+  uint32_t adc_value = 0;
+
+  if (MAP_ADCIntStatus(ADC0_BASE, ENTROPY_ADC_SEQ, false)) {
+    MAP_ADCIntClear(ADC0_BASE, ENTROPY_ADC_SEQ);
+    MAP_ADCSequenceDataGet(ADC0_BASE, ENTROPY_ADC_SEQ, &adc_value);
+    MAP_ADCProcessorTrigger(ADC0_BASE, ENTROPY_ADC_SEQ);
+  }
+
+  entropy_add_sample(adc_value);
+}
+
+/**
+ * @brief Mix caller supplied data into the pool
+ *
+ * @param data pointer to the data to mix in
+ * @param len number of bytes to mix in
+ */
+void entropy_add(const uint8_t *data, uint32_t len) {
+  for (uint32_t i = 0; i < len; i++) {
+    pending[pending_len] ^= data[i];
+    pending_len++;
+
+    if (pending_len == AES_BLOCKLEN) {
+      entropy_fold();
+    }
+  }
+}
+
+/**
+ * @brief Derive seed material from the pool
+ *
+ * @param seed pointer to ENTROPY_SEED_SIZE bytes of output
+ */
+void entropy_extract(uint8_t *seed) {
+  // Always fold, even an empty block, so the cost never varies
+  extract_count++;
+  for (int i = 0; i < (int)sizeof(extract_count); i++) {
+    pending[AES_BLOCKLEN - 1 - i] ^= (uint8_t)(extract_count >> (8 * i));
+  }
+  entropy_fold();
+
+  // Two output blocks and one ratchet block with distinct domain tags
+  for (int i = 0; i < ENTROPY_SEED_SIZE; i += AES_BLOCKLEN) {
+    memcpy(&seed[i], pool, AES_BLOCKLEN);
+    seed[i] ^= (uint8_t)(1 + i / AES_BLOCKLEN);
+    AES_ECB_encrypt(&condition_ctx, &seed[i]);
+  }
+
+  pool[0] ^= 0xFF;
+  AES_ECB_encrypt(&condition_ctx, pool);
+}
@@ -18,24 +18,29 @@
 
 #include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
 
-#include "driverlib/eeprom.h"
 #include "driverlib/gpio.h"
 #include "driverlib/interrupt.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/timer.h"
 
-#include "secrets.h"
-
 #include "board_link.h"
+#include "ct_util.h"
+#include "device_secrets.h"
+#include "drbg.h"
+#include "driverlib_map.h"
+#include "eeprom_cache.h"
+#include "entropy.h"
 #include "feature_list.h"
+#include "session.h"
 #include "uart.h"
 
 /*** Structure definitions ***/
 // Structure of start_car packet FEATURE_DATA
 typedef struct {
-  uint8_t car_id[8];
+  uint32_t car_id[CAR_ID_SIZE / sizeof(uint32_t)];
   uint8_t num_active;
   uint8_t features[NUM_FEATURES];
 } FEATURE_DATA;
@@ -45,6 +50,30 @@ typedef struct {
 #define UNLOCK_EEPROM_LOC 0x7C0
 #define UNLOCK_EEPROM_SIZE 64
 
+// Framing of the unlock response to the host, so the host can stop reading
+// as soon as the last feature arrives:
+//   'U' flags [nonce] unlock_message 'F' num_features features... [tag]
+// The nonce and tag are only present with RESPONSE_FLAG_AEAD. The tag then
+// covers the nonce, both headers and the encrypted messages
+#define RESPONSE_UNLOCK_MAGIC 'U'
+#define RESPONSE_FEATURE_MAGIC 'F'
+#define RESPONSE_FLAG_AEAD 0x01
+
+// DWT cycle counter, started from zero by Firmware_Startup - used to time
+// the boot and the unlock path
+#define DWT_CYCCNT 0xE0001004
+
+/*** Global variables ***/
+// Cycles from reset to the board link being polled for its first byte
+volatile uint32_t boot_cycles;
+
+// Cycles spent in the last unlock - read them with a debugger to compare a
+// normal build against one with NO_RAMFUNC=1
+volatile struct {
+  uint32_t check;  // token comparison
+  uint32_t crypto; // session key derivation, encryption and MAC
+} unlock_cycles;
+
 /*** Function definitions ***/
 // Core functions - unlockCar and startCar
 void unlockCar(void);
@@ -54,9 +83,9 @@ void startCar(void);
 void sendAckSuccess(void);
 void sendAckFailure(void);
 
-// Declare password
-const uint8_t pass[] = PASSWORD;
-const uint8_t car_id[] = CAR_ID;
+// Helper functions - writing the unlock response to the host
+void writeResponseHeader(uint8_t magic, uint8_t value);
+void writeResponse(uint8_t *buf, uint32_t len);
 
 // trust me, it's easier to get the boot reference flag by
 // getting this running than to try to untangle this
@@ -70,14 +99,21 @@ typedef uint32_t aErjfkdfru;const aErjfkdfru aseiFuengleR[]={0x1ffe4b6,0x3098ac,
  * If successful prints out the unlock flag.
  */
 int main(void) {
-  // Ensure EEPROM peripheral is enabled
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
-  EEPROMInit();
-
-  // Change LED color: red
-  GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_1, GPIO_PIN_1); // r
-  GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_2, 0); // b
-  GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, 0); // g
+  // Run from the PLL on the 16 MHz crystal, at 50 MHz. The UARTs take their
+  // baud rate from SysCtlClockGet(), so this comes first. It also puts
+  // SysTick on the crystal, independent of the PIOSC the entropy timer uses
+  MAP_SysCtlClockSet(SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN |
+                     SYSCTL_XTAL_16MHZ);
+
+  // Enable every peripheral up front. Each takes a few cycles to come out of
+  // reset, so the readiness waits below mostly find it ready already rather
+  // than waiting on each in turn
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
 
   // Initialize UART peripheral
   uart_init();
@@ -85,7 +121,34 @@ int main(void) {
   // Initialize board link UART
   setup_board_link();
 
+  // Change LED color: red
+  while (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOF)) {
+  }
+  MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_1, GPIO_PIN_1); // r
+  MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_2, 0); // b
+  MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, 0); // g
+
+#ifdef SESSION_AEAD
+  // Harvest boot entropy and seed the nonce generator
+  entropy_init();
+  drbg_init();
+#endif
+
+  boot_cycles = HWREG(DWT_CYCCNT);
+
   while (true) {
+#ifdef SESSION_AEAD
+    // Never blocks - picks up whatever noise is ready between requests
+    entropy_poll();
+#endif
+
+    // EEPROM initialization and the cache warm-up run while waiting for the
+    // fob, off the boot path - a request that arrives first waits for them
+    // when it reads the EEPROM. A step can block (EEPROMInit recovering an
+    // interrupted write), but the board link interrupt keeps receiving
+    while (!eeprom_cache_ready() && !board_link_avail()) {
+      eeprom_cache_poll();
+    }
 
     unlockCar();
   }
@@ -95,23 +158,44 @@ int main(void) {
  * @brief Function that handles unlocking of car
  */
 void unlockCar(void) {
-  // Create a message struct variable for receiving data
+  // Receive packet into a pool buffer with some error checking
   MESSAGE_PACKET message;
-  uint8_t buffer[256];
-  message.buffer = buffer;
-
-  // Receive packet with some error checking
+  message.buffer = message_buffer_alloc();
   receive_board_message_by_type(&message, UNLOCK_MAGIC);
 
-  // Pad payload to a string
-  message.buffer[message.message_len] = 0;
+  // If the data transfer is the password, unlock. The token is compared a
+  // word at a time in constant time; only its (public) length is checked
+  // up front
+  uint32_t start = HWREG(DWT_CYCCNT);
+  bool authorized =
+      (message.message_len == PASSWORD_SIZE) &
+      !ct_compare(message.buffer, device_secrets.password, PASSWORD_SIZE);
+  unlock_cycles.check = HWREG(DWT_CYCCNT) - start;
+  unlock_cycles.crypto = 0;
+
+  // Done with the token - startCar needs the buffer back
+  message_buffer_release(message.buffer);
+
+  if (authorized) {
+    // The response is read, encrypted and sent in place in one pool buffer
+    uint8_t *eeprom_message = message_buffer_alloc();
+
+#ifdef SESSION_AEAD
+    // One key derivation for the whole response, announced by its nonce
+    uint8_t nonce[DRBG_NONCE_SIZE];
+    drbg_generate_nonce(nonce);
+    start = HWREG(DWT_CYCCNT);
+    session_begin(nonce);
+    unlock_cycles.crypto += HWREG(DWT_CYCCNT) - start;
+    writeResponseHeader(RESPONSE_UNLOCK_MAGIC, RESPONSE_FLAG_AEAD);
+    uart_write(HOST_UART, nonce, sizeof(nonce));
+#else
+    writeResponseHeader(RESPONSE_UNLOCK_MAGIC, 0);
+#endif
 
-  // If the data transfer is the password, unlock
-  if (!strcmp((char *)(message.buffer), (char *)pass)) {
-    uint8_t eeprom_message[64];
     // Read last 64B of EEPROM
-    EEPROMRead((uint32_t *)eeprom_message, UNLOCK_EEPROM_LOC,
-               UNLOCK_EEPROM_SIZE);
+    eeprom_cache_read((uint32_t *)eeprom_message, UNLOCK_EEPROM_LOC,
+                      UNLOCK_EEPROM_SIZE);
 
     // Get flag for boot reference design, and replace end of unlock message
     // YOU ARE NOT ALLOWED TO DO THIS IN YOUR DESIGN
@@ -128,11 +212,21 @@ void unlockCar(void) {
     }
 
     // Write out full flag if applicable
-    uart_write(HOST_UART, eeprom_message, UNLOCK_EEPROM_SIZE);
+    writeResponse(eeprom_message, UNLOCK_EEPROM_SIZE);
+    message_buffer_release(eeprom_message);
 
     sendAckSuccess();
 
     startCar();
+
+#ifdef SESSION_AEAD
+    // Single MAC finalization covering every block of the response
+    uint8_t tag[SESSION_TAG_SIZE];
+    start = HWREG(DWT_CYCCNT);
+    session_finish(tag);
+    unlock_cycles.crypto += HWREG(DWT_CYCCNT) - start;
+    uart_write(HOST_UART, tag, sizeof(tag));
+#endif
   } else {
     sendAckFailure();
   }
@@ -142,70 +236,113 @@ void unlockCar(void) {
  * @brief Function that handles starting of car - feature list
  */
 void startCar(void) {
-  // Create a message struct variable for receiving data
+  // Receive start message into a pool buffer
   MESSAGE_PACKET message;
-  uint8_t buffer[256];
-  message.buffer = buffer;
-
-  // Receive start message
+  message.buffer = message_buffer_alloc();
   receive_board_message_by_type(&message, START_MAGIC);
 
-  FEATURE_DATA *feature_info = (FEATURE_DATA *)buffer;
+  // Parse the message in place
+  FEATURE_DATA *feature_info = (FEATURE_DATA *)message.buffer;
 
-  // Verify correct car id
-  if (strcmp((char *)car_id, (char *)feature_info->car_id)) {
+  // Verify correct car id - an empty feature list still ends the response
+  if (ct_compare(device_secrets.car_id, feature_info->car_id, CAR_ID_SIZE)) {
+    writeResponseHeader(RESPONSE_FEATURE_MAGIC, 0);
+    message_buffer_release(message.buffer);
     return;
   }
 
+  // Tell the host how many feature blocks follow
+  writeResponseHeader(RESPONSE_FEATURE_MAGIC, feature_info->num_active);
+
+  // Each feature is read, encrypted and sent in place in one pool buffer
+  uint8_t *eeprom_message = message_buffer_alloc();
+
   // Print out features for all active features
   for (int i = 0; i < feature_info->num_active; i++) {
-    uint8_t eeprom_message[64];
-
     uint32_t offset = feature_info->features[i] * FEATURE_SIZE;
 
     if (offset > FEATURE_END) {
         offset = FEATURE_END;
     }
 
-    EEPROMRead((uint32_t *)eeprom_message, FEATURE_END - offset, FEATURE_SIZE);
+    eeprom_cache_read((uint32_t *)eeprom_message, FEATURE_END - offset,
+                      FEATURE_SIZE);
 
-    uart_write(HOST_UART, eeprom_message, FEATURE_SIZE);
+    writeResponse(eeprom_message, FEATURE_SIZE);
   }
 
+  message_buffer_release(eeprom_message);
+  message_buffer_release(message.buffer);
+
   // Change LED color: green
-  GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_1, 0); // r
-  GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_2, 0); // b
-  GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, GPIO_PIN_3); // g
+  MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_1, 0); // r
+  MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_2, 0); // b
+  MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, GPIO_PIN_3); // g
+}
+
+/**
+ * @brief Function that writes a two byte framing header to the host
+ *
+ * Headers are sent in the clear so the host can always find the end of the
+ * response. With SESSION_AEAD they are absorbed into the running MAC.
+ *
+ * @param magic type of the header
+ * @param value flags or count carried by the header
+ */
+void writeResponseHeader(uint8_t magic, uint8_t value) {
+  uint8_t header[2] = {magic, value};
+#ifdef SESSION_AEAD
+  session_authenticate(header, sizeof(header));
+#endif
+  uart_write(HOST_UART, header, sizeof(header));
+}
+
+/**
+ * @brief Function that writes part of the unlock response to the host
+ *
+ * With SESSION_AEAD the data is encrypted in place under the session key
+ * and absorbed into the running MAC before it is sent.
+ *
+ * @param buf pointer to the data to send
+ * @param len number of bytes to send
+ */
+void writeResponse(uint8_t *buf, uint32_t len) {
+#ifdef SESSION_AEAD
+  uint32_t start = HWREG(DWT_CYCCNT);
+  session_encrypt(buf, len);
+  unlock_cycles.crypto += HWREG(DWT_CYCCNT) - start;
+#endif
+  uart_write(HOST_UART, buf, len);
 }
 
 /**
  * @brief Function to send successful ACK message
  */
 void sendAckSuccess(void) {
-  // Create packet for successful ack and send
+  // Create packet for successful ack in a pool buffer and send
   MESSAGE_PACKET message;
 
-  uint8_t buffer[1];
-  message.buffer = buffer;
+  message.buffer = message_buffer_alloc();
   message.magic = ACK_MAGIC;
-  buffer[0] = ACK_SUCCESS;
+  message.buffer[0] = ACK_SUCCESS;
   message.message_len = 1;
 
   send_board_message(&message);
+  message_buffer_release(message.buffer);
 }
 
 /**
  * @brief Function to send unsuccessful ACK message
  */
 void sendAckFailure(void) {
-  // Create packet for unsuccessful ack and send
+  // Create packet for unsuccessful ack in a pool buffer and send
   MESSAGE_PACKET message;
 
-  uint8_t buffer[1];
-  message.buffer = buffer;
+  message.buffer = message_buffer_alloc();
   message.magic = ACK_MAGIC;
-  buffer[0] = ACK_FAIL;
+  message.buffer[0] = ACK_FAIL;
   message.message_len = 1;
 
   send_board_message(&message);
+  message_buffer_release(message.buffer);
 }
@@ -0,0 +1,200 @@
+/**
+ * @file session.c
+ * @brief Per-unlock session keys and streaming authenticated encryption
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "aes.h"
+
+#include "ct_util.h"
+#include "device_secrets.h"
+#include "ramfunc.h"
+#include "session.h"
+
+// Context string for the key expansion
+#define SESSION_INFO "ectf-car-session"
+#define SESSION_INFO_LEN (sizeof(SESSION_INFO) - 1)
+
+/*** Structure definitions ***/
+// Incremental AES-CMAC state
+typedef struct {
+  struct AES_ctx ctx;
+  uint8_t k1[AES_BLOCKLEN];
+  uint8_t k2[AES_BLOCKLEN];
+  uint8_t x[AES_BLOCKLEN];
+  uint8_t buf[AES_BLOCKLEN];
+  uint32_t buf_len;
+} CMAC_STATE;
+
+static struct AES_ctx enc_ctx;
+static CMAC_STATE mac;
+
+/**
+ * @brief Multiply a block by x in GF(2^128) for the CMAC subkeys
+ *
+ * @param out pointer to the output block
+ * @param in pointer to the input block
+ */
+RAMFUNC static void cmac_double(uint8_t *out, const uint8_t *in) {
+  uint8_t carry = in[0] >> 7;
+
+  for (int i = 0; i < AES_BLOCKLEN - 1; i++) {
+    out[i] = (uint8_t)((in[i] << 1) | (in[i + 1] >> 7));
+  }
+  // Branch-free conditional reduction
+  out[AES_BLOCKLEN - 1] = (uint8_t)((in[AES_BLOCKLEN - 1] << 1) ^
+                                    ((0 - carry) & 0x87));
+}
+
+/**
+ * @brief Start a CMAC computation - runs the key schedule
+ *
+ * @param state pointer to the CMAC state
+ * @param key pointer to the AES-128 key
+ */
+static void cmac_init(CMAC_STATE *state, const uint8_t *key) {
+  uint8_t l[AES_BLOCKLEN] = {0};
+
+  AES_init_ctx(&state->ctx, key);
+  AES_ECB_encrypt(&state->ctx, l);
+  cmac_double(state->k1, l);
+  cmac_double(state->k2, state->k1);
+
+  memset(state->x, 0, AES_BLOCKLEN);
+  state->buf_len = 0;
+
+  ct_zeroize(l, sizeof(l));
+}
+
+/**
+ * @brief Absorb data into a CMAC computation
+ *
+ * The last full block is held back because finalization treats it
+ * differently from the ones before it.
+ *
+ * @param state pointer to the CMAC state
+ * @param data pointer to the data
+ * @param len number of bytes
+ */
+RAMFUNC static void cmac_update(CMAC_STATE *state, const uint8_t *data,
+                                uint32_t len) {
+  for (uint32_t i = 0; i < len; i++) {
+    if (state->buf_len == AES_BLOCKLEN) {
+      for (int j = 0; j < AES_BLOCKLEN; j++) {
+        state->x[j] ^= state->buf[j];
+      }
+      AES_ECB_encrypt(&state->ctx, state->x);
+      state->buf_len = 0;
+    }
+    state->buf[state->buf_len++] = data[i];
+  }
+}
+
+/**
+ * @brief Finish a CMAC computation
+ *
+ * @param state pointer to the CMAC state
+ * @param tag pointer to AES_BLOCKLEN bytes of output
+ */
+static void cmac_final(CMAC_STATE *state, uint8_t *tag) {
+  const uint8_t *subkey = state->k1;
+
+  // Pad a partial (or empty) last block and switch to the second subkey
+  if (state->buf_len < AES_BLOCKLEN) {
+    state->buf[state->buf_len] = 0x80;
+    memset(&state->buf[state->buf_len + 1], 0,
+           AES_BLOCKLEN - state->buf_len - 1);
+    subkey = state->k2;
+  }
+
+  for (int i = 0; i < AES_BLOCKLEN; i++) {
+    tag[i] = state->x[i] ^ state->buf[i] ^ subkey[i];
+  }
+  AES_ECB_encrypt(&state->ctx, tag);
+
+  ct_zeroize(state, sizeof(*state));
+}
+
+/**
+ * @brief Derive the session keys for one transaction
+ *
+ * @param nonce pointer to SESSION_NONCE_SIZE bytes, fresh for every session
+ */
+void session_begin(const uint8_t *nonce) {
+  uint8_t prk[AES_BLOCKLEN];
+  uint8_t enc_key[AES_BLOCKLEN];
+  uint8_t counter;
+  uint8_t zero_iv[AES_BLOCKLEN] = {0};
+
+  // Extract: PRK = CMAC(salt = nonce, root key)
+  cmac_init(&mac, nonce);
+  cmac_update(&mac, device_secrets.session_root_key,
+              sizeof(device_secrets.session_root_key));
+  cmac_final(&mac, prk);
+
+  // Expand: T(1) = CMAC(PRK, info | 1) is the encryption key
+  counter = 1;
+  cmac_init(&mac, prk);
+  cmac_update(&mac, (const uint8_t *)SESSION_INFO, SESSION_INFO_LEN);
+  cmac_update(&mac, &counter, 1);
+  cmac_final(&mac, enc_key);
+
+  // T(2) = CMAC(PRK, T(1) | info | 2) is the MAC key, kept in prk
+  counter = 2;
+  cmac_init(&mac, prk);
+  cmac_update(&mac, enc_key, sizeof(enc_key));
+  cmac_update(&mac, (const uint8_t *)SESSION_INFO, SESSION_INFO_LEN);
+  cmac_update(&mac, &counter, 1);
+  cmac_final(&mac, prk);
+
+  // The keys are fresh for every session, so the counter can start at zero
+  AES_init_ctx_iv(&enc_ctx, enc_key, zero_iv);
+
+  // Encrypt-then-MAC, with the nonce bound in as associated data
+  cmac_init(&mac, prk);
+  cmac_update(&mac, nonce, SESSION_NONCE_SIZE);
+
+  ct_zeroize(prk, sizeof(prk));
+  ct_zeroize(enc_key, sizeof(enc_key));
+}
+
+/**
+ * @brief Absorb data sent in the clear into the MAC
+ *
+ * @param buf pointer to the data
+ * @param len number of bytes
+ */
+void session_authenticate(const uint8_t *buf, uint32_t len) {
+  cmac_update(&mac, buf, len);
+}
+
+/**
+ * @brief Encrypt part of the response in place and absorb it into the MAC
+ *
+ * @param buf pointer to the data to encrypt
+ * @param len number of bytes to encrypt
+ */
+void session_encrypt(uint8_t *buf, uint32_t len) {
+  AES_CTR_xcrypt_buffer(&enc_ctx, buf, len);
+  cmac_update(&mac, buf, len);
+}
+
+/**
+ * @brief Finalize the MAC over everything encrypted and wipe the keys
+ *
+ * @param tag pointer to SESSION_TAG_SIZE bytes of output
+ */
+void session_finish(uint8_t *tag) {
+  cmac_final(&mac, tag);
+  ct_zeroize(&enc_ctx, sizeof(enc_ctx));
+}
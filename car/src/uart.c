@@ -25,22 +25,26 @@
 #include "inc/hw_types.h"
 #include "inc/hw_uart.h"
 
+#include "driverlib_map.h"
 #include "uart.h"
 
 /**
  * @brief Initialize the UART interfaces.
  *
- * UART 0 is used to communicate with the host computer.
+ * UART 0 is used to communicate with the host computer. UART 0 and GPIO
+ * Port A must already be enabled.
  */
 void uart_init(void) {
   // Configure the UART peripherals used in this example
-  // RCGC   Run Mode Clock Gating
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0); // UART 0 for host interface
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA); // UART 0 is on GPIO Port A
+  // RCGC   Run Mode Clock Gating - main() enables UART 0 and GPIO Port A
+  // along with the other peripherals, so only wait for them here
+  while (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_UART0) ||
+         !MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA)) {
+  }
   // HBCTL  High-performance Bus Control
   // PCTL   Port Control
-  GPIOPinConfigure(GPIO_PA0_U0RX);
-  GPIOPinConfigure(GPIO_PA1_U0TX);
+  MAP_GPIOPinConfigure(GPIO_PA0_U0RX);
+  MAP_GPIOPinConfigure(GPIO_PA1_U0TX);
   // DIR    Direction
   // AFSEL  Alternate Function Select
   // DR2R   2-mA Drive Select
@@ -52,11 +56,11 @@ void uart_init(void) {
   // PDR    Pull-Down Select
   // DEN    Digital Enable
   // AMSEL  Analog Mode Select
-  GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+  MAP_GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
 
   // Configure the UART for 115,200, 8-N-1 operation.
-  UARTConfigSetExpClk(
-      UART0_BASE, SysCtlClockGet(), 115200,
+  MAP_UARTConfigSetExpClk(
+      UART0_BASE, MAP_SysCtlClockGet(), 115200,
       (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
 }
 
@@ -67,7 +71,7 @@ void uart_init(void) {
  * @return true if there is data available.
  * @return false if there is no data available.
  */
-bool uart_avail(uint32_t uart) { return UARTCharsAvail(uart); }
+bool uart_avail(uint32_t uart) { return MAP_UARTCharsAvail(uart); }
 
 /**
  * @brief Read a byte from a UART interface.
@@ -75,7 +79,7 @@ bool uart_avail(uint32_t uart) { return UARTCharsAvail(uart); }
  * @param uart is the base address of the UART port to read from.
  * @return the character read from the interface.
  */
-int32_t uart_readb(uint32_t uart) { return UARTCharGet(uart); }
+int32_t uart_readb(uint32_t uart) { return MAP_UARTCharGet(uart); }
 
 /**
  * @brief Read a sequence of bytes from a UART interface.
@@ -126,7 +130,7 @@ uint32_t uart_readline(uint32_t uart, uint8_t *buf) {
  * @param uart is the base address of the UART port to write to.
  * @param data is the byte value to write.
  */
-void uart_writeb(uint32_t uart, uint8_t data) { UARTCharPut(uart, data); }
+void uart_writeb(uint32_t uart, uint8_t data) { MAP_UARTCharPut(uart, data); }
 
 /**
  * @brief Write a sequence of bytes to a UART interface.
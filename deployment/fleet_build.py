@@ -0,0 +1,182 @@
+#!/usr/bin/python3 -u
+
+# @file fleet_build
+# @brief Build every car and fob of a manifest in parallel
+# @date 2023
+#
+# This source file is part of an example system for MITRE's 2023 Embedded CTF (eCTF).
+# This code is being provided only for educational purposes for the 2023 MITRE eCTF
+# competition,and may not meet MITRE standards for quality. Use this code at your
+# own risk!
+#
+# @copyright Copyright (c) 2023 The MITRE Corporation
+
+import os
+import re
+import csv
+import sys
+import json
+import time
+import argparse
+import subprocess
+from pathlib import Path
+from concurrent.futures import ThreadPoolExecutor
+
+# Design root - the car and fob directories sit next to deployment/
+DESIGN_ROOT = Path(__file__).resolve().parent.parent
+
+# Source directory and make target of each device type
+DEVICE_TYPES = {
+    "car": ("car", "car"),
+    "paired_fob": ("fob", "paired_fob"),
+    "unpaired_fob": ("fob", "unpaired_fob"),
+}
+
+# Compiler and linker warnings in a build log
+WARNING_RE = re.compile(r"\bwarning:")
+
+
+# @brief Read the device entries of a manifest
+#
+# CSV manifests need a header row; JSON manifests are a list of objects.
+# Each entry has name and type (car, paired_fob or unpaired_fob), plus car_id
+# for cars and paired fobs and pair_pin for paired fobs.
+# @param manifest, path of the .csv or .json manifest
+def read_manifest(manifest):
+    with open(manifest, "r", newline="") as fhandle:
+        if manifest.suffix.lower() == ".json":
+            devices = json.load(fhandle)
+        else:
+            devices = list(csv.DictReader(fhandle))
+
+    for device in devices:
+        if device.get("type") not in DEVICE_TYPES:
+            raise ValueError(f"{device.get('name')}: unknown type {device.get('type')}")
+    return devices
+
+
+# @brief Create an isolated build directory for one device
+#
+# Everything is symlinked to the shared sources except inc/secrets.h and the
+# object directory, which each device gets its own copy of.
+# @param source, car or fob source directory
+# @param build_dir, per-device build directory
+def stage(source, build_dir):
+    (build_dir / "inc").mkdir(parents=True, exist_ok=True)
+
+    for entry in source.iterdir():
+        link = build_dir / entry.name
+        if entry.name in ("inc", "gcc") or link.exists():
+            continue
+        link.symlink_to(entry)
+
+    for header in (source / "inc").iterdir():
+        link = build_dir / "inc" / header.name
+        if header.name == "secrets.h" or link.exists():
+            continue
+        link.symlink_to(header)
+
+
+# @brief Build one device
+# @param device, manifest entry of the device
+# @param secrets_dir, deployment secrets directory
+# @param out_dir, fleet output directory
+# @param make_args, extra arguments passed to every make
+# @return (name, seconds, returncode, number of warnings in the build log)
+def build(device, secrets_dir, out_dir, make_args):
+    name = device["name"]
+    source, target = DEVICE_TYPES[device["type"]]
+    build_dir = out_dir / "build" / name
+    device_dir = out_dir / name
+    device_dir.mkdir(parents=True, exist_ok=True)
+    stage(DESIGN_ROOT / source, build_dir)
+
+    command = [
+        "make",
+        target,
+        f"SECRETS_DIR={secrets_dir}",
+        f"BIN_PATH={device_dir / 'firmware.bin'}",
+        f"ELF_PATH={device_dir / 'firmware.elf'}",
+        f"EEPROM_PATH={device_dir / 'eeprom.bin'}",
+    ] + make_args
+    if device.get("car_id"):
+        command.append(f"CAR_ID={device['car_id']}")
+    if device.get("pair_pin"):
+        command.append(f"PAIR_PIN={device['pair_pin']}")
+
+    start = time.monotonic()
+    with open(device_dir / "build.log", "w") as log:
+        result = subprocess.run(
+            command, cwd=build_dir, stdout=log, stderr=subprocess.STDOUT
+        )
+    elapsed = time.monotonic() - start
+
+    with open(device_dir / "build.log", "r", errors="replace") as log:
+        warnings = sum(1 for line in log if WARNING_RE.search(line))
+
+    status = "ok" if result.returncode == 0 else "FAILED"
+    if warnings:
+        status += f", {warnings} warning(s)"
+    if result.returncode != 0 or warnings:
+        status += f" (see {name}/build.log)"
+    print(f"{name:<24}{device['type']:<14}{elapsed:>8.2f} s  {status}")
+    return name, elapsed, result.returncode, warnings
+
+
+# @brief Main function
+#
+# Main function builds the shared libraries once, then every car and then
+# every fob in parallel. Fobs go after cars because paired fobs read their
+# car's entry from the secrets file. With --werror a device that built with
+# warnings counts as failed.
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--manifest", type=Path, required=True)
+    parser.add_argument("--secrets-dir", type=Path, required=True)
+    parser.add_argument("--out-dir", type=Path, required=True)
+    parser.add_argument("--jobs", type=int, default=os.cpu_count())
+    parser.add_argument(
+        "--werror", action="store_true", help="fail devices that built with warnings"
+    )
+    args = parser.parse_args()
+
+    devices = read_manifest(args.manifest)
+    secrets_dir = args.secrets_dir.resolve()
+    out_dir = args.out_dir.resolve()
+    make_args = [f"DRIVERLIB_CACHE={out_dir / 'driverlib_cache'}"]
+
+    # driverlib builds inside the shared source tree, so build it up front
+    # rather than from several device builds at once
+    start = time.monotonic()
+    for source in sorted({DEVICE_TYPES[d["type"]][0] for d in devices}):
+        subprocess.run(
+            ["make", "tivaware"] + make_args, cwd=DESIGN_ROOT / source, check=True
+        )
+
+    results = []
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        for stage_types in (("car",), ("paired_fob", "unpaired_fob")):
+            stage_devices = [d for d in devices if d["type"] in stage_types]
+            results += pool.map(
+                lambda d: build(d, secrets_dir, out_dir, make_args), stage_devices
+            )
+    wall = time.monotonic() - start
+
+    failed = [
+        name
+        for name, _, returncode, warnings in results
+        if returncode != 0 or (args.werror and warnings)
+    ]
+    total = sum(elapsed for _, elapsed, _, _ in results)
+    warned = sum(1 for _, _, _, warnings in results if warnings)
+    print(
+        f"\n{len(results) - len(failed)}/{len(results)} devices built in {wall:.2f} s"
+        f" ({total:.2f} s of device builds, {args.jobs} jobs),"
+        f" {warned} with warnings"
+    )
+    if failed:
+        sys.exit(f"Failed: {', '.join(failed)}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/python3 -u
+
+# @file rom_report
+# @brief Compare car and fob images built against flash and ROM driverlib
+# @date 2023
+#
+# This source file is part of an example system for MITRE's 2023 Embedded CTF (eCTF).
+# This code is being provided only for educational purposes for the 2023 MITRE eCTF
+# competition,and may not meet MITRE standards for quality. Use this code at your
+# own risk!
+#
+# @copyright Copyright (c) 2023 The MITRE Corporation
+
+import sys
+import argparse
+import tempfile
+import subprocess
+from pathlib import Path
+
+from fleet_build import DESIGN_ROOT, DEVICE_TYPES, build
+
+# Flash erase block of the TM4C123 - the bootloader programs whole pages
+FLASH_PAGE = 1024
+
+# One device of each image the design ships
+DEVICES = [
+    {"name": "car", "type": "car", "car_id": "1"},
+    {"name": "unpaired_fob", "type": "unpaired_fob"},
+]
+
+# make arguments of each variant
+VARIANTS = {
+    "flash": [],
+    "rom": ["ROM_DRIVERLIB=1"],
+}
+
+
+# @brief Measure one built image
+# @param device_dir, output directory of the device
+# @return dict of bin bytes, flash pages and text/data/bss section sizes
+def measure(device_dir):
+    size = subprocess.run(
+        ["arm-none-eabi-size", str(device_dir / "firmware.elf")],
+        check=True,
+        capture_output=True,
+        text=True,
+    )
+    text, data, bss = (int(field) for field in size.stdout.splitlines()[1].split()[:3])
+    image = (device_dir / "firmware.bin").stat().st_size
+
+    return {
+        "bin": image,
+        "pages": -(-image // FLASH_PAGE),
+        "text": text,
+        "data": data,
+        "bss": bss,
+    }
+
+
+# @brief Main function
+#
+# Main function builds every device once per variant, each in its own build
+# directory, and prints the sizes side by side with the saving of the ROM
+# build. Fewer pages means proportionally less time erasing and programming.
+# Only sizes are reported: boot time needs the images running on the boards,
+# so it is not measured here.
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--out-dir", type=Path, required=True)
+    args = parser.parse_args()
+
+    out_dir = args.out_dir.resolve()
+    make_args = [f"DRIVERLIB_CACHE={out_dir / 'driverlib_cache'}"]
+
+    for source in sorted({DEVICE_TYPES[d["type"]][0] for d in DEVICES}):
+        subprocess.run(
+            ["make", "tivaware"] + make_args, cwd=DESIGN_ROOT / source, check=True
+        )
+
+    sizes = {}
+    with tempfile.TemporaryDirectory() as secrets_dir:
+        (Path(secrets_dir) / "global_secrets.txt").write_text("SECRET!\n")
+        for variant, variant_args in VARIANTS.items():
+            variant_dir = out_dir / variant
+            for device in DEVICES:
+                _, _, returncode, _ = build(
+                    device, Path(secrets_dir), variant_dir, make_args + variant_args
+                )
+                if returncode != 0:
+                    sys.exit(f"{variant} {device['name']} failed to build")
+                sizes[variant, device["name"]] = measure(variant_dir / device["name"])
+
+    fields = ("bin", "pages", "text", "data", "bss")
+    print(f"\n{'':<24}" + "".join(f"{field:>9}" for field in fields))
+    for device in DEVICES:
+        name = device["name"]
+        for variant in VARIANTS:
+            row = sizes[variant, name]
+            print(
+                f"{name + ' ' + variant:<24}"
+                + "".join(f"{row[field]:>9}" for field in fields)
+            )
+        print(
+            f"{name + ' saved':<24}"
+            + "".join(
+                f"{sizes['flash', name][field] - sizes['rom', name][field]:>9}"
+                for field in fields
+            )
+        )
+
+    print(
+        "\nBoot time is not measured - flash each variant and read the car's"
+        "\nboot_cycles with a debugger, or the fob's boot_us with the timing"
+        "\nhost command."
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,277 @@
+#!/usr/bin/python3 -u
+
+# @file size_report
+# @brief Report flash and SRAM use of car and fob builds from their linker maps
+# @date 2023
+#
+# This source file is part of an example system for MITRE's 2023 Embedded CTF (eCTF).
+# This code is being provided only for educational purposes for the 2023 MITRE eCTF
+# competition,and may not meet MITRE standards for quality. Use this code at your
+# own risk!
+#
+# @copyright Copyright (c) 2023 The MITRE Corporation
+
+import re
+import sys
+import json
+import argparse
+from pathlib import Path
+
+# Size classes, as reported by arm-none-eabi-size
+CLASSES = ("text", "data", "bss")
+
+MEMORY_RE = re.compile(r"^(\w+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)")
+HEX_RE = re.compile(r"^0x[0-9a-f]+$")
+ARCHIVE_RE = re.compile(r"([^/]+\.a)\(([^)]+)\)$")
+
+# Prefixes -ffunction-sections and -fdata-sections put in front of the name
+SYMBOL_PREFIXES = (".text.", ".rodata.", ".data.", ".bss.", ".ramfunc.")
+
+
+# @brief Shorten an object path so it does not depend on the build directory
+# @param path, object or archive member as written in the map
+def object_name(path):
+    if not path:
+        return "(fill)"
+    match = ARCHIVE_RE.search(path)
+    if match:
+        return f"{match.group(1)}({match.group(2)})"
+    return Path(path).name
+
+
+# @brief Name the symbol an input section holds
+#
+# Sections without a per-symbol suffix (hand-written assembly, .ramfunc,
+# .eh_frame) keep their section name. Objects the car Makefile moved to SRAM
+# have .ramfunc in front of their usual section names.
+# @param section, input section name
+def symbol_name(section):
+    if section.startswith(".ramfunc."):
+        section = section[len(".ramfunc") :]
+    for prefix in SYMBOL_PREFIXES:
+        if section.startswith(prefix):
+            return section[len(prefix) :]
+    return section
+
+
+# @brief Parse a GNU ld map file
+#
+# Output sections are classed by where they sit: flash without an SRAM copy
+# is text, anything copied to SRAM at startup (.data, .ramfunc) is data and
+# SRAM that is only zeroed is bss. .stack is kept apart, and sections outside
+# both regions (debug info) are skipped.
+# @param map_file, path of the map written by the linker
+# @return dict of totals, memory, objects and symbols
+def parse_map(map_file):
+    memory = {}
+    totals = dict.fromkeys(CLASSES + ("stack",), 0)
+    objects = {}
+    symbols = {}
+
+    lines = map_file.read_text().splitlines()
+    for heading in ("Memory Configuration", "Linker script and memory map"):
+        if heading not in lines:
+            raise ValueError(f"{map_file} is not a GNU ld map (no '{heading}')")
+    start = lines.index("Linker script and memory map")
+    for line in lines[lines.index("Memory Configuration") : start]:
+        match = MEMORY_RE.match(line)
+        if match and match.group(1) != "Name":
+            memory[match.group(1)] = (int(match.group(2), 16), int(match.group(3), 16))
+
+    def region(address):
+        for name, (origin, length) in memory.items():
+            if origin <= address < origin + length:
+                return name
+        return None
+
+    current = None  # size class of the output section being read
+    output = None  # output section still waiting for its address
+    section = None  # input section still waiting for its address
+    for line in lines[start + 1 :]:
+        fields = line.split()
+        if not fields:
+            continue
+
+        if not line.startswith(" "):
+            # Output section, or LOAD and OUTPUT lines
+            current, section = None, None
+            output = fields[0] if fields[0].startswith(".") else None
+            fields = fields[1:]
+        elif not line.startswith("  ") and "(" not in fields[0]:
+            # Input section - "(" marks the linker script patterns
+            section = fields[0]
+            fields = fields[1:]
+
+        # Address and size, on the same line as the name or the next one
+        if len(fields) < 2 or not all(HEX_RE.match(f) for f in fields[:2]):
+            continue
+        address, size = int(fields[0], 16), int(fields[1], 16)
+
+        if output:
+            where = region(address)
+            if output == ".stack":
+                totals["stack"] += size
+            elif where == "FLASH":
+                current = "text"
+            elif where == "SRAM":
+                current = "data" if "load" in fields else "bss"
+            output = None
+            continue
+
+        if current is None or section is None or size == 0:
+            section = None
+            continue
+
+        obj = object_name(" ".join(fields[2:]))
+        symbol = symbol_name(section)
+        totals[current] += size
+        objects.setdefault(obj, dict.fromkeys(CLASSES, 0))[current] += size
+        entry = symbols.setdefault(f"{obj}:{symbol}", {"class": current, "size": 0})
+        entry["size"] += size
+        section = None
+
+    return {"totals": totals, "memory": memory, "objects": objects, "symbols": symbols}
+
+
+# @brief Format a size change
+# @param new, current size
+# @param old, baseline size, or None where the baseline has no such entry
+def delta(new, old):
+    if old is None or new == old:
+        return ""
+    return f"{new - old:+d}"
+
+
+# @brief Print the report of one build
+# @param name, label of the build
+# @param sizes, parsed map from parse_map()
+# @param baseline, parsed map stored for this build
+# @param top, number of symbols listed
+# @return list of the size classes that grew against the baseline
+def report(name, sizes, baseline, top):
+    totals = sizes["totals"]
+    old_totals = baseline["totals"]
+    flash = totals["text"] + totals["data"]
+    sram = totals["data"] + totals["bss"] + totals["stack"]
+    old_flash = old_totals["text"] + old_totals["data"]
+    old_sram = old_totals["data"] + old_totals["bss"] + old_totals["stack"]
+
+    print(f"== {name} ==")
+    for cls in CLASSES + ("stack",):
+        print(f"{cls:<8}{totals[cls]:>9}{delta(totals[cls], old_totals.get(cls)):>9}")
+    for label, used, old, region in (
+        ("flash", flash, old_flash, "FLASH"),
+        ("sram", sram, old_sram, "SRAM"),
+    ):
+        length = sizes["memory"].get(region, (0, 0))[1]
+        print(
+            f"{label:<8}{used:>9}{delta(used, old):>9}  of {length}"
+            f" ({length - used} free)"
+        )
+
+    print("\nPer object (size and change against the baseline):")
+    print("".join(f"{cls:>14}" for cls in CLASSES))
+    old_objects = baseline["objects"]
+    for obj in sorted(
+        set(sizes["objects"]) | set(old_objects),
+        key=lambda o: -sum(sizes["objects"].get(o, {}).values()),
+    ):
+        row = sizes["objects"].get(obj, dict.fromkeys(CLASSES, 0))
+        old = old_objects.get(obj, dict.fromkeys(CLASSES, 0))
+        print(
+            "".join(f"{row[c]:>7}{delta(row[c], old[c]):>7}" for c in CLASSES)
+            + f"  {obj}"
+        )
+
+    symbols = sizes["symbols"]
+    old_symbols = baseline["symbols"]
+    print(f"\nLargest symbols, top {top}:")
+    for key in sorted(symbols, key=lambda k: (-symbols[k]["size"], k))[:top]:
+        entry = symbols[key]
+        old = old_symbols.get(key, {}).get("size")
+        print(
+            f"{entry['size']:>7}{delta(entry['size'], old):>7}"
+            f"  {entry['class']:<5}{key}"
+        )
+
+    changed = sorted(
+        key
+        for key in set(symbols) | set(old_symbols)
+        if symbols.get(key, {}).get("size") != old_symbols.get(key, {}).get("size")
+    )
+    print(f"\nSymbols changed since the baseline: {len(changed) or 'none'}")
+    for key in changed:
+        new = symbols.get(key, {}).get("size", 0)
+        old = old_symbols.get(key, {}).get("size", 0)
+        print(f"{new:>7}{new - old:>+7}  {key}")
+    print()
+
+    return [cls for cls in CLASSES if totals[cls] > old_totals[cls]]
+
+
+# @brief Main function
+#
+# Main function reports every build given on the command line against the
+# baseline file, or stores the builds as the new baseline with --update. It
+# exits non-zero if .text, .data or .bss of any build grew, so growth has to
+# be accepted by updating the baseline, and if there is no baseline to check
+# a build against.
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        "builds", nargs="+", help="NAME=MAP linker map of each build"
+    )
+    parser.add_argument("--baseline", type=Path, required=True)
+    parser.add_argument(
+        "--update", action="store_true", help="store the builds as the baseline"
+    )
+    parser.add_argument("--top", type=int, default=20)
+    args = parser.parse_args()
+
+    store_hint = "run `make size_baseline` on a known-good build to store one"
+    baselines = {}
+    if args.baseline.exists():
+        try:
+            baselines = json.loads(args.baseline.read_text())
+        except ValueError as e:
+            sys.exit(f"Baseline {args.baseline} is not valid JSON ({e}) - {store_hint}")
+    elif not args.update:
+        sys.exit(f"No baseline: {args.baseline} does not exist - {store_hint}")
+
+    grown = []
+    missing = []
+    for build in args.builds:
+        name, _, map_file = build.partition("=")
+        if not map_file:
+            parser.error(f"expected NAME=MAP, got {build}")
+        try:
+            sizes = parse_map(Path(map_file))
+        except (OSError, ValueError) as e:
+            sys.exit(f"Cannot read the {name} map: {e}")
+        if args.update:
+            baselines[name] = sizes
+            continue
+        if name not in baselines:
+            missing.append(name)
+            continue
+        grown += [
+            f"{name} {cls}" for cls in report(name, sizes, baselines[name], args.top)
+        ]
+
+    if args.update:
+        args.baseline.write_text(json.dumps(baselines, indent=4, sort_keys=True) + "\n")
+        print(f"Stored {', '.join(sorted(baselines))} in {args.baseline}")
+        return
+    errors = []
+    if missing:
+        errors.append(
+            f"No baseline for {', '.join(missing)} in {args.baseline} - {store_hint}"
+        )
+    if grown:
+        errors.append(f"Grew since the baseline: {', '.join(grown)}")
+    if errors:
+        sys.exit("\n".join(errors))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,192 @@
+#!/usr/bin/python3 -u
+
+# @file stack_report
+# @brief Report worst-case stack use per call chain of car and fob builds
+# @date 2023
+#
+# This source file is part of an example system for MITRE's 2023 Embedded CTF (eCTF).
+# This code is being provided only for educational purposes for the 2023 MITRE eCTF
+# competition,and may not meet MITRE standards for quality. Use this code at your
+# own risk!
+#
+# @copyright Copyright (c) 2023 The MITRE Corporation
+
+import re
+import sys
+import argparse
+from pathlib import Path
+
+# Design root - the car and fob directories sit next to deployment/
+DESIGN_ROOT = Path(__file__).resolve().parent.parent
+
+# Registers stacked on exception entry. The firmware never enables the FPU, so
+# there is no floating point context on top.
+EXCEPTION_FRAME = 32
+
+NODE_RE = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE_RE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+FRAME_RE = re.compile(r"\\n(\d+) bytes \(([a-z,]+)\)")
+STACK_SIZE_RE = re.compile(r"_STACK_SIZE\s*=\s*(0x[0-9a-fA-F]+|\d+)\s*;")
+
+
+# @brief Load the call graph of one build
+#
+# Reads the .ci files gcc writes next to each object with
+# -fcallgraph-info=su. Functions that are only called (driverlib, libc) have
+# no frame size and count as 0 bytes.
+# @param build_dir, object directory of the build
+# @return (frames, calls) - frames maps a function to (bytes, qualifier),
+#     calls maps a function to the set of functions it calls
+def load_graph(build_dir):
+    frames = {}
+    calls = {}
+    for ci_file in sorted(build_dir.glob("*.ci")):
+        text = ci_file.read_text()
+        for title, label in NODE_RE.findall(text):
+            match = FRAME_RE.search(label)
+            if match:
+                frames[title] = (int(match.group(1)), match.group(2))
+        for source, target in EDGE_RE.findall(text):
+            calls.setdefault(source, set()).add(target)
+
+    if not frames:
+        sys.exit(f"{build_dir}: no .ci files - build with STACK_USAGE=1")
+    return frames, calls
+
+
+# @brief Find the deepest call chain below every function
+# @param frames, frame sizes from load_graph()
+# @param calls, call edges from load_graph()
+# @return dict of function to (worst-case bytes, chain as a list of functions)
+def worst_chains(frames, calls):
+    worst = {}
+    active = set()
+
+    def visit(func):
+        if func in worst:
+            return worst[func]
+        if func in active:
+            # Recursion has no static bound - stop here and flag the chain
+            return 0, [func + " (recursive)"]
+
+        active.add(func)
+        depth, chain = 0, []
+        for callee in sorted(calls.get(func, ())):
+            callee_depth, callee_chain = visit(callee)
+            if callee_depth > depth or not chain:
+                depth, chain = callee_depth, callee_chain
+        active.discard(func)
+
+        worst[func] = (frames.get(func, (0, ""))[0] + depth, [func] + chain)
+        return worst[func]
+
+    for func in sorted(frames):
+        visit(func)
+    return worst
+
+
+# @brief Format a call chain with the frame of each function
+# @param chain, list of functions from worst_chains()
+# @param frames, frame sizes from load_graph()
+def format_chain(chain, frames):
+    parts = []
+    for func in chain:
+        if func not in frames:
+            parts.append(f"{func} (?)")
+            continue
+        size, qualifier = frames[func]
+        dynamic = "+" if "dynamic" in qualifier else ""
+        parts.append(f"{func} ({size}{dynamic})")
+    return " > ".join(parts)
+
+
+# @brief Print the report of one build
+# @param name, label of the build
+# @param build_dir, object directory of the build
+# @param indirect, dict of caller to the functions it calls through pointers
+# @param stack_size, size of the stack reserved by firmware.ld
+# @param top, number of functions listed in the per-function table
+def report(name, build_dir, indirect, stack_size, top):
+    frames, calls = load_graph(build_dir)
+
+    # Replace the indirect call placeholder with the known targets
+    for caller, callees in indirect.items():
+        if caller in calls:
+            calls[caller].discard("__indirect_call")
+            calls[caller].update(callees)
+
+    worst = worst_chains(frames, calls)
+    called = set().union(*calls.values()) if calls else set()
+    roots = sorted(
+        (f for f in frames if f not in called), key=lambda f: -worst[f][0]
+    )
+
+    print(f"== {name} ({build_dir}) ==")
+    print("\nWorst chain from each root (bytes per frame, + dynamic, ? unknown):")
+    for root in roots:
+        depth, chain = worst[root]
+        print(f"{depth:>7}  {format_chain(chain, frames)}")
+
+    # Thread mode runs from the entry point; interrupt handlers all use the
+    # default priority, so at most one is stacked on top of it
+    thread = max((worst[r][0] for r in roots if not r.endswith("ISR")), default=0)
+    isr = max((worst[r][0] for r in roots if r.endswith("ISR")), default=0)
+    total = thread + (isr + EXCEPTION_FRAME if isr else 0)
+
+    print(f"\nPer function, top {top} (own frame, worst including callees):")
+    by_depth = sorted(frames, key=lambda f: (-worst[f][0], f))[:top]
+    for func in by_depth:
+        print(f"{frames[func][0]:>7}{worst[func][0]:>7}  {func}")
+
+    print(
+        f"\nBudget: thread {thread} + interrupt {isr}"
+        f"{f' + frame {EXCEPTION_FRAME}' if isr else ''} = {total} of"
+        f" {stack_size} bytes ({stack_size - total} spare)\n"
+    )
+    return total <= stack_size
+
+
+# @brief Main function
+#
+# Main function reports every build given on the command line and exits
+# non-zero if any build's worst case does not fit in the reserved stack.
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        "builds",
+        nargs="+",
+        help="NAME=DIR object directories built with STACK_USAGE=1",
+    )
+    parser.add_argument(
+        "--ld",
+        type=Path,
+        default=DESIGN_ROOT / "car" / "lib" / "tivaware" / "firmware.ld",
+        help="linker script that sets _STACK_SIZE",
+    )
+    parser.add_argument(
+        "--indirect",
+        action="append",
+        default=[],
+        help="CALLER=CALLEE,... functions a caller reaches through pointers",
+    )
+    parser.add_argument("--top", type=int, default=15)
+    args = parser.parse_args()
+
+    stack_size = int(STACK_SIZE_RE.search(args.ld.read_text()).group(1), 0)
+
+    indirect = {}
+    for entry in args.indirect:
+        caller, callees = entry.split("=", 1)
+        indirect[caller] = set(callees.split(","))
+
+    fits = True
+    for build in args.builds:
+        name, build_dir = build.split("=", 1)
+        fits &= report(name, Path(build_dir), indirect, stack_size, args.top)
+
+    if not fits:
+        sys.exit("Worst-case stack use exceeds _STACK_SIZE")
+
+
+if __name__ == "__main__":
+    main()
@@ -12,10 +12,86 @@
 #
 # @copyright Copyright (c) 2023 The MITRE Corporation
 
+import os
 import json
+import struct
+import tempfile
 import argparse
 from pathlib import Path
 
+# Must match CAR_ID_SIZE, PASSWORD_SIZE and PAIR_PIN_SIZE in inc/board_link.h
+CAR_ID_SIZE = 8
+PASSWORD_SIZE = 16
+PAIR_PIN_SIZE = 8
+
+
+# @brief Zero pad a secret to its fixed size
+# @param data, bytes of the secret
+# @param size, fixed size of the secret in bytes
+def pad(data, size):
+    if len(data) > size:
+        raise ValueError(f"{data!r} does not fit in {size} bytes")
+    return data + b"\0" * (size - len(data))
+
+
+# @brief Format bytes as a C initializer of little-endian uint32_t words
+# @param data, bytes to format - length must be a multiple of 4
+def words_init(data):
+    words = struct.unpack(f"<{len(data) // 4}I", data)
+    return "{" + ", ".join(f"0x{w:08x}" for w in words) + "}"
+
+
+# @brief Replace a file's content only if it changed
+#
+# Leaves the file (and its mtime) alone when the content is the same, so make
+# sees no change. Otherwise writes a temp file and renames it into place, so
+# readers never see a partial file.
+# @param path, path of the file to write
+# @param text, new content of the file
+def write_if_changed(path, text):
+    if path.exists() and path.read_text() == text:
+        return
+
+    fd, tmp = tempfile.mkstemp(dir=path.parent, prefix=f".{path.name}.")
+    with os.fdopen(fd, "w") as fp:
+        fp.write(text)
+    os.chmod(tmp, 0o644)
+    os.replace(tmp, path)
+
+
+# @brief Pre-derived secrets of one fob
+#
+# Unpaired fobs get all-zero secrets. Shared with patch_secrets.py.
+# @param paired, whether the fob is built paired
+# @param car_id, id of the paired car
+# @param pair_pin, pairing pin of the paired fob
+# @param secret_file, path of the JSON secret file written for the car
+def fob_secrets(paired, car_id=None, pair_pin=None, secret_file=None):
+    if not paired:
+        return {
+            "paired": False,
+            "car_secret": "000000",
+            "pair_pin": bytes(PAIR_PIN_SIZE),
+            "car_id": bytes(CAR_ID_SIZE),
+            "password": bytes(PASSWORD_SIZE),
+        }
+
+    # Open the secret file, get the car's secret and unlock token - car builds
+    # replace it atomically, so no lock is needed to read it
+    with open(secret_file, "r") as fp:
+        secrets = json.load(fp)
+        car_secret = secrets[str(car_id)]
+        password = bytes.fromhex(secrets["passwords"][str(car_id)])
+
+    # Fixed-size forms of the pin and id
+    return {
+        "paired": True,
+        "car_secret": car_secret,
+        "pair_pin": pad(pair_pin.encode(), PAIR_PIN_SIZE),
+        "car_id": pad(str(car_id).encode(), CAR_ID_SIZE),
+        "password": password,
+    }
+
 
 def main():
     parser = argparse.ArgumentParser()
@@ -26,33 +102,20 @@ def main():
     parser.add_argument("--paired", action="store_true")
     args = parser.parse_args()
 
-    if args.paired:
-        # Open the secret file, get the car's secret
-        with open(args.secret_file, "r") as fp:
-            secrets = json.load(fp)
-            car_secret = secrets[str(args.car_id)]
-
-        # Write to header file
-        with open(args.header_file, "w") as fp:
-            fp.write("#ifndef __FOB_SECRETS__\n")
-            fp.write("#define __FOB_SECRETS__\n\n")
-            fp.write("#define PAIRED 1\n")
-            fp.write(f'#define PAIR_PIN "{args.pair_pin}"\n')
-            fp.write(f'#define CAR_ID "{args.car_id}"\n')
-            fp.write(f'#define CAR_SECRET "{car_secret}"\n\n')
-            fp.write('#define PASSWORD "unlock"\n\n')
-            fp.write("#endif\n")
-    else:
-        # Write to header file
-        with open(args.header_file, "w") as fp:
-            fp.write("#ifndef __FOB_SECRETS__\n")
-            fp.write("#define __FOB_SECRETS__\n\n")
-            fp.write("#define PAIRED 0\n")
-            fp.write('#define PAIR_PIN "000000"\n')
-            fp.write('#define CAR_ID "000000"\n')
-            fp.write('#define CAR_SECRET "000000"\n\n')
-            fp.write('#define PASSWORD "unlock"\n\n')
-            fp.write("#endif\n")
+    secrets = fob_secrets(args.paired, args.car_id, args.pair_pin, args.secret_file)
+
+    # Write to header file - untouched if the secrets did not change
+    write_if_changed(
+        args.header_file,
+        "#ifndef __FOB_SECRETS__\n"
+        "#define __FOB_SECRETS__\n\n"
+        f"#define PAIRED {int(secrets['paired'])}\n"
+        f"#define PAIR_PIN {words_init(secrets['pair_pin'])}\n"
+        f"#define CAR_ID {words_init(secrets['car_id'])}\n"
+        f'#define CAR_SECRET "{secrets["car_secret"]}"\n\n'
+        f"#define PASSWORD {words_init(secrets['password'])}\n\n"
+        "#endif\n",
+    )
 
 
 if __name__ == "__main__":
@@ -28,6 +28,19 @@
 #define START_MAGIC 0x57
 #define BOARD_UART ((uint32_t)UART1_BASE)
 
+// Sizes of the fixed-size secrets generated by gen_secret.py, all multiples
+// of a word so they can be compared a word at a time
+#define CAR_ID_SIZE 8
+#define PASSWORD_SIZE 16
+#define PAIR_PIN_SIZE 8
+
+// Message buffers hold the largest payload (message_len is one byte) and are
+// word aligned so payloads can be viewed as packet structs
+#define MESSAGE_BUFFER_SIZE 256
+
+// Buffers in the message pool - receiveAck is the only receive into the pool
+#define MESSAGE_POOL_SIZE 1
+
 /**
  * @brief Structure for message between boards
  *
@@ -42,7 +55,8 @@ typedef struct
 /**
  * @brief Set the up board link object
  *
- * UART 1 is used to communicate between boards
+ * UART 1 is used to communicate between boards. UART 1 and GPIO Port B must
+ * already be enabled.
  */
 void setup_board_link(void);
 
@@ -71,4 +85,22 @@ uint32_t receive_board_message(MESSAGE_PACKET *message);
  */
 uint32_t receive_board_message_by_type(MESSAGE_PACKET *message, uint8_t type);
 
+/**
+ * @brief Take a buffer from the message pool
+ *
+ * Not safe to call from interrupt handlers. The pool is sized for the
+ * firmware's own callers, so running out is a bug: it raises a fault
+ * (FaultISR) instead of returning NULL.
+ *
+ * @return uint8_t* a MESSAGE_BUFFER_SIZE buffer
+ */
+uint8_t *message_buffer_alloc(void);
+
+/**
+ * @brief Return a buffer to the message pool
+ *
+ * @param buffer buffer returned by message_buffer_alloc()
+ */
+void message_buffer_release(uint8_t *buffer);
+
 #endif
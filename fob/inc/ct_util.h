@@ -0,0 +1,51 @@
+/**
+ * @file ct_util.h
+ * @brief Constant-time comparison, copy and zeroize helpers for secrets
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef CT_UTIL_H
+#define CT_UTIL_H
+
+#include <stdint.h>
+
+#include "ramfunc.h"
+
+/**
+ * @brief Compare two buffers in time that depends only on the length
+ *
+ * Unlike strcmp/memcmp this never stops at the first difference or at a
+ * NUL. Word-aligned buffers are compared a word at a time.
+ *
+ * @param a pointer to the first buffer
+ * @param b pointer to the second buffer
+ * @param len number of bytes to compare
+ * @return uint32_t 0 if the buffers are equal, 1 otherwise
+ */
+RAMFUNC uint32_t ct_compare(const void *a, const void *b, uint32_t len);
+
+/**
+ * @brief Copy a buffer in time that depends only on the length
+ *
+ * @param dst pointer to the destination buffer
+ * @param src pointer to the source buffer
+ * @param len number of bytes to copy
+ */
+RAMFUNC void ct_copy(void *dst, const void *src, uint32_t len);
+
+/**
+ * @brief Clear a buffer in a way the compiler cannot optimize out
+ *
+ * @param buf pointer to the buffer to clear
+ * @param len number of bytes to clear
+ */
+RAMFUNC void ct_zeroize(void *buf, uint32_t len);
+
+#endif
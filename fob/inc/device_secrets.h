@@ -0,0 +1,44 @@
+/**
+ * @file device_secrets.h
+ * @brief Per-device secrets block at a fixed flash address
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef DEVICE_SECRETS_H
+#define DEVICE_SECRETS_H
+
+#include <stdint.h>
+
+#include "board_link.h"
+
+// Must match _SECRETS_ADDR in firmware.ld and patch_secrets.py
+#define SECRETS_ADDR 0x00008400
+#define SECRETS_MAGIC 0x52434553 // "SECR"
+
+/*** Structure definitions ***/
+// Layout of the secrets block - patch_secrets.py writes the same layout into
+// a prebuilt image, so fields may only be appended
+typedef struct {
+  uint32_t magic;
+  uint32_t paired;
+  uint32_t car_id[CAR_ID_SIZE / sizeof(uint32_t)];
+  uint32_t password[PASSWORD_SIZE / sizeof(uint32_t)];
+  uint32_t pair_pin[PAIR_PIN_SIZE / sizeof(uint32_t)];
+} DEVICE_SECRETS;
+
+/**
+ * @brief Secrets of this fob
+ *
+ * Defined in its own translation unit so reads are never folded into code
+ * and a patched block takes effect without recompiling.
+ */
+extern const DEVICE_SECRETS device_secrets;
+
+#endif
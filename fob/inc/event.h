@@ -0,0 +1,72 @@
+/**
+ * @file event.h
+ * @brief Cooperative event loop that deep sleeps the core while idle
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Events posted by interrupt handlers
+ *
+ * A posted event is queued at most once until its handler runs, so the
+ * queue never overflows and a handler must drain everything its source has
+ * ready rather than assume one event per byte or edge.
+ */
+typedef enum {
+  EVENT_HOST_RX,  // host UART received data
+  EVENT_BOARD_RX, // board link UART received data
+  EVENT_SW1,      // press of SW1, posted on its first edge
+  NUM_EVENTS
+} EVENT;
+
+typedef void (*EVENT_HANDLER)(void);
+
+/**
+ * @brief Set the handler run for an event
+ *
+ * Events without a handler are dropped when dequeued.
+ *
+ * @param event the event to handle
+ * @param handler function run to completion from the event loop
+ */
+void event_register(EVENT event, EVENT_HANDLER handler);
+
+/**
+ * @brief Queue an event - safe to call from interrupt handlers
+ *
+ * @param event the event to queue
+ */
+void event_post(EVENT event);
+
+/**
+ * @brief Run handlers for queued events in order, forever
+ *
+ * Puts the core in deep sleep (SysCtlDeepSleep) whenever the queue is empty.
+ * Only peripherals enabled with SysCtlPeripheralDeepSleepEnable keep running,
+ * and the system clock switches to the deep-sleep clock, so every interrupt
+ * source must be set up to work without the run-mode clock.
+ */
+void event_loop(void);
+
+/**
+ * @brief Timestamp of the most recent wake from deep sleep
+ *
+ * Taken before the waking interrupt's handler runs, so latencies measured
+ * from it include the interrupt and event dispatch.
+ *
+ * @return the timestamp, as returned by timing_now()
+ */
+uint32_t event_wake_time(void);
+
+#endif
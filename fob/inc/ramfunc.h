@@ -0,0 +1,32 @@
+/**
+ * @file ramfunc.h
+ * @brief Marker for functions run from SRAM
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+/**
+ * @brief Place a function in the .ramfunc section
+ *
+ * Firmware_Startup copies .ramfunc to SRAM, where the function runs without
+ * flash wait states. SRAM is out of branch range of flash, so calls go
+ * through a register (long_call) - use the macro on the prototype as well as
+ * the definition. Build with NO_RAMFUNC=1 to leave these functions in flash
+ * for comparison.
+ */
+#ifdef NO_RAMFUNC
+#define RAMFUNC
+#else
+#define RAMFUNC __attribute__((section(".ramfunc"), long_call, noinline))
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file stack_usage.h
+ * @brief Stack high-water mark kept by the startup code
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef STACK_USAGE_H
+#define STACK_USAGE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Most stack used since startup
+ *
+ * Defined in startup_gcc.c, which paints the stack before calling main. A
+ * full stack and an overflow both report the whole stack size.
+ *
+ * @return uint32_t the high-water mark in bytes
+ */
+uint32_t StackHighWaterMark(void);
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @file timing.h
+ * @brief Free-running timestamp counter and recorded latencies
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+
+// Timestamps count the 16 MHz PIOSC, independent of the system clock
+#define TIMING_TICKS_PER_US 16
+
+/**
+ * @brief Latencies recorded by the firmware, in microseconds
+ *
+ * Each field holds the most recent measurement, or 0 if none was taken yet.
+ * Sent to the host as-is (little-endian words) by the "timing" command.
+ */
+typedef struct {
+  uint32_t sw1_unlock_us;  // SW1 press edge to unlock message sent
+  uint32_t wake_unlock_us; // last wake from deep sleep to unlock message sent
+  uint32_t boot_us;        // reset to the board link waiting for its first byte
+} TIMING_STATS;
+
+extern TIMING_STATS timing_stats;
+
+/**
+ * @brief Start the free-running timestamp counter
+ *
+ * Uses TIMER2 as a full width periodic timer clocked from the PIOSC. Wraps
+ * after about 268 s, so only measure intervals shorter than that. TIMER2
+ * must already be enabled.
+ */
+void timing_init(void);
+
+/**
+ * @brief Read the current timestamp
+ *
+ * Safe to call from interrupt handlers.
+ *
+ * @return the timestamp in ticks, counting up
+ */
+uint32_t timing_now(void);
+
+/**
+ * @brief Time elapsed since a timestamp
+ *
+ * @param start timestamp returned by timing_now()
+ * @return the elapsed time in microseconds
+ */
+uint32_t timing_elapsed_us(uint32_t start);
+
+/**
+ * @brief Time elapsed since reset
+ *
+ * Reads the DWT cycle counter started by Firmware_Startup, which stops while
+ * the core deep sleeps - only meaningful before the first sleep.
+ *
+ * @return the elapsed time in microseconds
+ */
+uint32_t timing_since_reset_us(void);
+
+#endif
@@ -22,10 +22,15 @@
 
 #define HOST_UART ((uint32_t)UART0_BASE)
 
+// UARTs are clocked from the 16 MHz PIOSC so they keep their baud rate, and
+// keep receiving, while the system clock is switched in deep sleep
+#define UART_PIOSC_HZ 16000000
+
 /**
  * @brief Initialize the UART interfaces.
  *
- * UART 0 is used to communicate with the door/fob.
+ * UART 0 is used to communicate with the door/fob. UART 0 and GPIO Port A
+ * must already be enabled.
  */
 void uart_init(void);
 
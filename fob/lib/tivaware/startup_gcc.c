@@ -76,8 +76,35 @@ static volatile uint32_t pui32Stack[64];
 extern uint32_t _ldata;
 extern uint32_t _data;
 extern uint32_t _edata;
+extern uint32_t _lramfunc;
+extern uint32_t _ramfunc;
+extern uint32_t _eramfunc;
 extern uint32_t _bss;
 extern uint32_t _ebss;
+extern uint32_t _stack_bottom;
+extern uint32_t _stack_top;
+
+//*****************************************************************************
+//
+// Pattern painted over the whole application stack at startup.  Words that
+// still hold it have never been written, which gives the high-water mark.
+//
+//*****************************************************************************
+#define STACK_PAINT             0xC5C5C5C5
+#define STACK_PAINT_STR(x)      #x
+#define STACK_PAINT_ASM(x)      STACK_PAINT_STR(x)
+
+//*****************************************************************************
+//
+// DWT cycle counter.  Firmware_Startup starts it from zero, so the
+// application can read how long its boot took.
+//
+//*****************************************************************************
+#define DEMCR                   0xE000EDFC
+#define DEMCR_TRCENA            0x01000000
+#define DWT_CTRL                0xE0001000
+#define DWT_CTRL_CYCCNTENA      0x00000001
+#define DWT_CYCCNT              0xE0001004
 
 //*****************************************************************************
 //
@@ -96,30 +123,82 @@ void Firmware_Startup(void)
     __asm("    ldr sp, =pui32Stack\n"
           "    add sp, sp, #256");
 
-    uint32_t *pui32Src, *pui32Dest;
+    //
+    // Start the cycle counter from zero.
+    //
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
 
     //
-    // Copy the data segment initializers from flash to SRAM.
+    // Copy the data segment initializers and the functions that run from SRAM
+    // from flash to SRAM, four words per LDM/STM burst.  firmware.ld keeps
+    // both sections and their load addresses word aligned, so only whole
+    // words are left over for the single word tail.
     //
-    pui32Src = &_ldata;
-    for(pui32Dest = &_data; pui32Dest < &_edata; )
-    {
-        *pui32Dest++ = *pui32Src++;
-    }
+    __asm volatile("    ldr     r0, =_ldata\n"
+                   "    ldr     r1, =_data\n"
+                   "    ldr     r2, =_edata\n"
+                   "    bl      copy_words\n"
+                   "    ldr     r0, =_lramfunc\n"
+                   "    ldr     r1, =_ramfunc\n"
+                   "    ldr     r2, =_eramfunc\n"
+                   "    bl      copy_words\n"
+                   "    b       copy_done\n"
+                   "    .thumb_func\n"
+                   "copy_words:\n"
+                   "        sub     r3, r2, r1\n"
+                   "        cmp     r3, #16\n"
+                   "        blt     copy_tail\n"
+                   "        ldmia   r0!, {r4-r6, r12}\n"
+                   "        stmia   r1!, {r4-r6, r12}\n"
+                   "        b       copy_words\n"
+                   "copy_tail:\n"
+                   "        cmp     r1, r2\n"
+                   "        itt     lt\n"
+                   "        ldrlt   r3, [r0], #4\n"
+                   "        strlt   r3, [r1], #4\n"
+                   "        blt     copy_tail\n"
+                   "        bx      lr\n"
+                   "copy_done:"
+                   : : : "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r12",
+                         "lr", "cc", "memory");
 
     //
-    // Zero fill the bss segment. Set the actual application stack pointer
+    // Zero fill the bss segment and paint the stack, again four words per STM
+    // burst.  Set the actual application stack pointer first; nothing is on
+    // the stack yet, as sp is at the top.
     //
-    __asm("    ldr     r0, =_bss\n"
-          "    ldr     r1, =_ebss\n"
-          "    mov     r2, #0\n"
-          "    ldr     sp, =_stack_top\n"
-          "    .thumb_func\n"
-          "zero_loop:\n"
-          "        cmp     r0, r1\n"
-          "        it      lt\n"
-          "        strlt   r2, [r0], #4\n"
-          "        blt     zero_loop");
+    __asm volatile("    ldr     sp, =_stack_top\n"
+                   "    ldr     r0, =_bss\n"
+                   "    ldr     r1, =_ebss\n"
+                   "    mov     r4, #0\n"
+                   "    bl      fill_words\n"
+                   "    ldr     r0, =_stack_bottom\n"
+                   "    ldr     r1, =_stack_top\n"
+                   "    ldr     r4, =" STACK_PAINT_ASM(STACK_PAINT) "\n"
+                   "    bl      fill_words\n"
+                   "    b       fill_done\n"
+                   "    .thumb_func\n"
+                   "fill_words:\n"
+                   "        mov     r5, r4\n"
+                   "        mov     r6, r4\n"
+                   "        mov     r12, r4\n"
+                   "fill_burst:\n"
+                   "        sub     r3, r1, r0\n"
+                   "        cmp     r3, #16\n"
+                   "        blt     fill_tail\n"
+                   "        stmia   r0!, {r4-r6, r12}\n"
+                   "        b       fill_burst\n"
+                   "fill_tail:\n"
+                   "        cmp     r0, r1\n"
+                   "        it      lt\n"
+                   "        strlt   r4, [r0], #4\n"
+                   "        blt     fill_tail\n"
+                   "        bx      lr\n"
+                   "fill_done:"
+                   : : : "r0", "r1", "r3", "r4", "r5", "r6", "r12", "lr",
+                         "cc", "memory");
 
     //
     // Call the application's entry point.
@@ -127,6 +206,27 @@ void Firmware_Startup(void)
     main();
 }
 
+//*****************************************************************************
+//
+// Returns the most stack, in bytes, used since startup.  Scans up from the
+// bottom of the stack for the first word that no longer holds the paint
+// pattern, so a full stack reports _STACK_SIZE and an overflow cannot be told
+// apart from it.
+//
+//*****************************************************************************
+uint32_t
+StackHighWaterMark(void)
+{
+    uint32_t *pui32Word = &_stack_bottom;
+
+    while((pui32Word < &_stack_top) && (*pui32Word == STACK_PAINT))
+    {
+        pui32Word++;
+    }
+
+    return((&_stack_top - pui32Word) * sizeof(uint32_t));
+}
+
 //*****************************************************************************
 //
 // This is the code that gets called when the processor receives a NMI.  This
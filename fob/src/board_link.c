@@ -13,6 +13,7 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "inc/hw_memmap.h"
@@ -25,28 +26,38 @@
 #include "driverlib/uart.h"
 
 #include "board_link.h"
+#include "driverlib_map.h"
+#include "uart.h"
+
+// Fixed pool of message buffers and which of them are handed out
+static uint8_t message_pool[MESSAGE_POOL_SIZE][MESSAGE_BUFFER_SIZE]
+    __attribute__((aligned(4)));
+static bool message_used[MESSAGE_POOL_SIZE];
 
 /**
  * @brief Set the up board link object
  *
- * UART 1 is used to communicate between boards
+ * UART 1 is used to communicate between boards. UART 1 and GPIO Port B must
+ * already be enabled.
  */
 void setup_board_link(void) {
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+  while (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_UART1) ||
+         !MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOB)) {
+  }
 
-  GPIOPinConfigure(GPIO_PB0_U1RX);
-  GPIOPinConfigure(GPIO_PB1_U1TX);
+  MAP_GPIOPinConfigure(GPIO_PB0_U1RX);
+  MAP_GPIOPinConfigure(GPIO_PB1_U1TX);
 
-  GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+  MAP_GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
 
   // Configure the UART for 115,200, 8-N-1 operation.
-  UARTConfigSetExpClk(
-      BOARD_UART, SysCtlClockGet(), 115200,
+  MAP_UARTClockSourceSet(BOARD_UART, UART_CLOCK_PIOSC);
+  MAP_UARTConfigSetExpClk(
+      BOARD_UART, UART_PIOSC_HZ, 115200,
       (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
 
-  while (UARTCharsAvail(BOARD_UART)) {
-    UARTCharGet(BOARD_UART);
+  while (MAP_UARTCharsAvail(BOARD_UART)) {
+    MAP_UARTCharGet(BOARD_UART);
   }
 }
 
@@ -57,11 +68,11 @@ void setup_board_link(void) {
  * @return uint32_t the number of bytes sent
  */
 uint32_t send_board_message(MESSAGE_PACKET *message) {
-  UARTCharPut(BOARD_UART, message->magic);
-  UARTCharPut(BOARD_UART, message->message_len);
+  MAP_UARTCharPut(BOARD_UART, message->magic);
+  MAP_UARTCharPut(BOARD_UART, message->message_len);
 
   for (int i = 0; i < message->message_len; i++) {
-    UARTCharPut(BOARD_UART, message->buffer[i]);
+    MAP_UARTCharPut(BOARD_UART, message->buffer[i]);
   }
 
   return message->message_len;
@@ -74,16 +85,16 @@ uint32_t send_board_message(MESSAGE_PACKET *message) {
  * @return uint32_t the number of bytes received - 0 for error
  */
 uint32_t receive_board_message(MESSAGE_PACKET *message) {
-  message->magic = (uint8_t)UARTCharGet(BOARD_UART);
+  message->magic = (uint8_t)MAP_UARTCharGet(BOARD_UART);
 
   if (message->magic == 0) {
     return 0;
   }
 
-  message->message_len = (uint8_t)UARTCharGet(BOARD_UART);
+  message->message_len = (uint8_t)MAP_UARTCharGet(BOARD_UART);
 
   for (int i = 0; i < message->message_len; i++) {
-    message->buffer[i] = (uint8_t)UARTCharGet(BOARD_UART);
+    message->buffer[i] = (uint8_t)MAP_UARTCharGet(BOARD_UART);
   }
 
   return message->message_len;
@@ -103,3 +114,30 @@ uint32_t receive_board_message_by_type(MESSAGE_PACKET *message, uint8_t type) {
 
   return message->message_len;
 }
+
+/**
+ * @brief Take a buffer from the message pool
+ *
+ * @return uint8_t* a MESSAGE_BUFFER_SIZE buffer
+ */
+uint8_t *message_buffer_alloc(void) {
+  for (int i = 0; i < MESSAGE_POOL_SIZE; i++) {
+    if (!message_used[i]) {
+      message_used[i] = true;
+      return message_pool[i];
+    }
+  }
+
+  // MESSAGE_POOL_SIZE is too small for the callers - a leak or a new
+  // caller. Fault rather than hand out NULL to be written through.
+  __builtin_trap();
+}
+
+/**
+ * @brief Return a buffer to the message pool
+ *
+ * @param buffer buffer returned by message_buffer_alloc()
+ */
+void message_buffer_release(uint8_t *buffer) {
+  message_used[(buffer - message_pool[0]) / MESSAGE_BUFFER_SIZE] = false;
+}
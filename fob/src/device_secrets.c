@@ -0,0 +1,26 @@
+/**
+ * @file device_secrets.c
+ * @brief Per-device secrets block at a fixed flash address
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include "secrets.h"
+
+#include "device_secrets.h"
+
+// Build-time values from secrets.h - patch_secrets.py may replace them
+const DEVICE_SECRETS device_secrets
+    __attribute__((section(".secrets"), used)) = {
+        .magic = SECRETS_MAGIC,
+        .paired = PAIRED,
+        .car_id = CAR_ID,
+        .password = PASSWORD,
+        .pair_pin = PAIR_PIN,
+};
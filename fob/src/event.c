@@ -0,0 +1,95 @@
+/**
+ * @file event.c
+ * @brief Cooperative event loop that deep sleeps the core while idle
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+
+#include "driverlib_map.h"
+#include "event.h"
+#include "timing.h"
+
+// Each event is queued at most once, so NUM_EVENTS slots always suffice
+static volatile uint8_t queue[NUM_EVENTS];
+static volatile uint32_t queue_head;
+static volatile uint32_t queue_tail;
+static volatile uint32_t queued;
+
+static EVENT_HANDLER handlers[NUM_EVENTS];
+
+// Timestamp of the most recent return from deep sleep
+static volatile uint32_t wake_time;
+
+/**
+ * @brief Set the handler run for an event
+ *
+ * @param event the event to handle
+ * @param handler function run to completion from the event loop
+ */
+void event_register(EVENT event, EVENT_HANDLER handler) {
+  handlers[event] = handler;
+}
+
+/**
+ * @brief Queue an event - safe to call from interrupt handlers
+ *
+ * @param event the event to queue
+ */
+void event_post(EVENT event) {
+  bool was_masked = MAP_IntMasterDisable();
+
+  if (!(queued & (1 << event))) {
+    queued |= 1 << event;
+    queue[queue_tail] = event;
+    queue_tail = (queue_tail + 1) % NUM_EVENTS;
+  }
+
+  if (!was_masked) {
+    MAP_IntMasterEnable();
+  }
+}
+
+/**
+ * @brief Run handlers for queued events in order, forever
+ */
+void event_loop(void) {
+  while (true) {
+    // Check and sleep with interrupts masked so an event posted in between
+    // still wakes the WFI - its handler runs once interrupts are unmasked
+    MAP_IntMasterDisable();
+    if (!queued) {
+      MAP_SysCtlDeepSleep();
+      wake_time = timing_now();
+      MAP_IntMasterEnable();
+      continue;
+    }
+
+    EVENT event = queue[queue_head];
+    queue_head = (queue_head + 1) % NUM_EVENTS;
+    queued &= ~(1 << event);
+    MAP_IntMasterEnable();
+
+    if (handlers[event]) {
+      handlers[event]();
+    }
+  }
+}
+
+/**
+ * @brief Timestamp of the most recent wake from deep sleep
+ *
+ * @return the timestamp, as returned by timing_now()
+ */
+uint32_t event_wake_time(void) { return wake_time; }
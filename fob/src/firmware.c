@@ -26,11 +26,16 @@
 #include "driverlib/pin_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/timer.h"
-
-#include "secrets.h"
+#include "driverlib/uart.h"
 
 #include "board_link.h"
+#include "ct_util.h"
+#include "device_secrets.h"
+#include "driverlib_map.h"
+#include "event.h"
 #include "feature_list.h"
+#include "stack_usage.h"
+#include "timing.h"
 #include "uart.h"
 
 // this will run if EXAMPLE_AES is defined in the Makefile (see line 54)
@@ -46,26 +51,41 @@
 #define FLASH_PAIRED 0x00
 #define FLASH_UNPAIRED 0xFF
 
+// Most packages applied by one enable_batch command
+#define ENABLE_BATCH_MAX 32
+
+// Per-package status codes in the enable_batch reply
+#define ENABLE_OK 0x00
+#define ENABLE_DUPLICATE 0x01
+#define ENABLE_WRONG_CAR 0x02
+#define ENABLE_FULL 0x03
+#define ENABLE_BAD_PACKET 0x04
+
+// SW1 edges are ignored until it has read released at two checks this far
+// apart - 10 ms
+#define SW1_DEBOUNCE_TIMER_BASE TIMER1_BASE
+#define SW1_DEBOUNCE_TICKS (10000 * TIMING_TICKS_PER_US)
+
 /*** Structure definitions ***/
 // Defines a struct for the format of an enable message
 typedef struct
 {
-  uint8_t car_id[8];
+  uint32_t car_id[CAR_ID_SIZE / sizeof(uint32_t)];
   uint8_t feature;
 } ENABLE_PACKET;
 
 // Defines a struct for the format of a pairing message
 typedef struct
 {
-  uint8_t car_id[8];
-  uint8_t password[8];
-  uint8_t pin[8];
+  uint32_t car_id[CAR_ID_SIZE / sizeof(uint32_t)];
+  uint32_t password[PASSWORD_SIZE / sizeof(uint32_t)];
+  uint32_t pin[PAIR_PIN_SIZE / sizeof(uint32_t)];
 } PAIR_PACKET;
 
 // Defines a struct for the format of start message
 typedef struct
 {
-  uint8_t car_id[8];
+  uint32_t car_id[CAR_ID_SIZE / sizeof(uint32_t)];
   uint8_t num_active;
   uint8_t features[NUM_FEATURES];
 } FEATURE_DATA;
@@ -84,10 +104,37 @@ void saveFobState(FLASH_DATA *flash_data);
 void pairFob(FLASH_DATA *fob_state_ram);
 void unlockCar(FLASH_DATA *fob_state_ram);
 void enableFeature(FLASH_DATA *fob_state_ram);
+void enableFeatureBatch(FLASH_DATA *fob_state_ram);
 void startCar(FLASH_DATA *fob_state_ram);
+void reportTiming(void);
+void reportStack(void);
 
 // Helper functions - receive ack message
 uint8_t receiveAck();
+uint8_t applyEnable(FLASH_DATA *fob_state_ram, ENABLE_PACKET *enable_message);
+
+// Event handlers - run from the event loop
+void handleHostRx(void);
+void handleSw1(void);
+
+// Interrupt handlers - post events
+void hostUartISR(void);
+void boardUartISR(void);
+void sw1ISR(void);
+void sw1DebounceISR(void);
+
+// Fob state in ram - shared by the event handlers
+static FLASH_DATA fob_state_ram;
+
+// Buffer for assembling host commands - fits "enable_batch"
+static uint8_t uart_buffer[16];
+static uint8_t uart_buffer_index = 0;
+
+// Timestamp of the SW1 press edge being handled
+static volatile uint32_t sw1_press_time;
+
+// Whether SW1 read released at the last debounce check
+static bool sw1_released;
 
 /**
  * @brief Main function for the fob example
@@ -99,24 +146,45 @@ uint8_t receiveAck();
  */
 int main(void)
 {
-  FLASH_DATA fob_state_ram;
   FLASH_DATA *fob_state_flash = (FLASH_DATA *)FOB_STATE_PTR;
 
-// If paired fob, initialize the system information
-#if PAIRED == 1
-  if (fob_state_flash->paired == FLASH_UNPAIRED)
+  // Enable every peripheral up front. Each takes a few cycles to come out of
+  // reset, which overlaps with loading the fob state below, so the readiness
+  // waits in the init functions mostly find it ready already
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+  MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER2);
+
+  // Start from a clean state so fixed-size fields are zero padded
+  memset(&fob_state_ram, 0, sizeof(fob_state_ram));
+
+  // If paired fob, initialize the system information - paired is part of
+  // the secrets block so one image serves both builds
+  if (device_secrets.paired)
   {
-    strcpy((char *)(fob_state_ram.pair_info.password), PASSWORD);
-    strcpy((char *)(fob_state_ram.pair_info.pin), PAIR_PIN);
-    strcpy((char *)(fob_state_ram.pair_info.car_id), CAR_ID);
-    strcpy((char *)(fob_state_ram.feature_info.car_id), CAR_ID);
-    fob_state_ram.paired = FLASH_PAIRED;
-
-    saveFobState(&fob_state_ram);
+    if (fob_state_flash->paired == FLASH_UNPAIRED)
+    {
+      ct_copy(fob_state_ram.pair_info.password, device_secrets.password,
+              PASSWORD_SIZE);
+      ct_copy(fob_state_ram.pair_info.pin, device_secrets.pair_pin,
+              PAIR_PIN_SIZE);
+      ct_copy(fob_state_ram.pair_info.car_id, device_secrets.car_id,
+              CAR_ID_SIZE);
+      ct_copy(fob_state_ram.feature_info.car_id, device_secrets.car_id,
+              CAR_ID_SIZE);
+      fob_state_ram.paired = FLASH_PAIRED;
+
+      saveFobState(&fob_state_ram);
+    }
+  }
+  else
+  {
+    fob_state_ram.paired = FLASH_UNPAIRED;
   }
-#else
-  fob_state_ram.paired = FLASH_UNPAIRED;
-#endif
 
   if (fob_state_flash->paired == FLASH_PAIRED)
   {
@@ -158,78 +226,230 @@ int main(void)
   // Initialize board link UART
   setup_board_link();
 
+  // Start the timestamp counter used for latency measurements
+  timing_init();
+
   // Setup SW1
-  GPIOPinTypeGPIOInput(GPIO_PORTF_BASE, GPIO_PIN_4);
-  GPIOPadConfigSet(GPIO_PORTF_BASE, GPIO_PIN_4, GPIO_STRENGTH_4MA,
+  while (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOF))
+  {
+  }
+  MAP_GPIOPinTypeGPIOInput(GPIO_PORTF_BASE, GPIO_PIN_4);
+  MAP_GPIOPadConfigSet(GPIO_PORTF_BASE, GPIO_PIN_4, GPIO_STRENGTH_4MA,
                    GPIO_PIN_TYPE_STD_WPU);
 
   // Change LED color: white
-  GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_1, GPIO_PIN_1); // r
-  GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_2, GPIO_PIN_2); // b
-  GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, GPIO_PIN_3); // g
+  MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_1, GPIO_PIN_1); // r
+  MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_2, GPIO_PIN_2); // b
+  MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, GPIO_PIN_3); // g
+
+  // Host and board UART receive interrupts - the receive timeout interrupt
+  // covers bytes left below the FIFO trigger level
+  event_register(EVENT_HOST_RX, handleHostRx);
+  UARTIntRegister(HOST_UART, hostUartISR);
+  MAP_UARTIntEnable(HOST_UART, UART_INT_RX | UART_INT_RT);
+
+  // Board link data only arrives in reply to a request, and the blocking
+  // readers consume it, so EVENT_BOARD_RX just wakes the loop
+  UARTIntRegister(BOARD_UART, boardUartISR);
+  MAP_UARTIntEnable(BOARD_UART, UART_INT_RX | UART_INT_RT);
+
+  // SW1 debounce timer - one-shot from the PIOSC, so the debounce time does
+  // not depend on the system clock
+  while (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER1))
+  {
+  }
+  MAP_TimerClockSourceSet(SW1_DEBOUNCE_TIMER_BASE, TIMER_CLOCK_PIOSC);
+  MAP_TimerConfigure(SW1_DEBOUNCE_TIMER_BASE, TIMER_CFG_ONE_SHOT);
+  TimerIntRegister(SW1_DEBOUNCE_TIMER_BASE, TIMER_A, sw1DebounceISR);
+  MAP_TimerIntEnable(SW1_DEBOUNCE_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+  // SW1 interrupt on the press (falling) edge posts the press and starts the
+  // debounce
+  event_register(EVENT_SW1, handleSw1);
+  MAP_GPIOIntRegister(GPIO_PORTF_BASE, sw1ISR);
+  MAP_GPIOIntTypeSet(GPIO_PORTF_BASE, GPIO_PIN_4, GPIO_FALLING_EDGE);
+  MAP_GPIOIntClear(GPIO_PORTF_BASE, GPIO_INT_PIN_4);
+  MAP_GPIOIntEnable(GPIO_PORTF_BASE, GPIO_INT_PIN_4);
+
+  // Deep sleep between events - keep clocking only the wake sources
+  // (SW1, both UARTs and their pins) and the timers, all of which run from
+  // the PIOSC. Flash and SRAM stay fully powered so waking stays fast.
+  MAP_SysCtlPeripheralClockGating(true);
+  MAP_SysCtlPeripheralDeepSleepEnable(SYSCTL_PERIPH_GPIOA);
+  MAP_SysCtlPeripheralDeepSleepEnable(SYSCTL_PERIPH_GPIOB);
+  MAP_SysCtlPeripheralDeepSleepEnable(SYSCTL_PERIPH_GPIOF);
+  MAP_SysCtlPeripheralDeepSleepEnable(SYSCTL_PERIPH_UART0);
+  MAP_SysCtlPeripheralDeepSleepEnable(SYSCTL_PERIPH_UART1);
+  MAP_SysCtlPeripheralDeepSleepEnable(SYSCTL_PERIPH_TIMER1);
+  MAP_SysCtlPeripheralDeepSleepEnable(SYSCTL_PERIPH_TIMER2);
+  MAP_SysCtlDeepSleepClockSet(SYSCTL_DSLP_DIV_1 | SYSCTL_DSLP_OSC_INT);
+  SysCtlDeepSleepPowerSet(SYSCTL_FLASH_NORMAL | SYSCTL_SRAM_NORMAL);
+
+  timing_stats.boot_us = timing_since_reset_us();
+
+  // Run handlers as events arrive, sleeping in between
+  event_loop();
+}
 
-  // Declare a buffer for reading and writing to UART
-  uint8_t uart_buffer[10];
-  uint8_t uart_buffer_index = 0;
+/**
+ * @brief Interrupt handler for the host UART
+ */
+void hostUartISR(void)
+{
+  MAP_UARTIntClear(HOST_UART, MAP_UARTIntStatus(HOST_UART, true));
+  event_post(EVENT_HOST_RX);
+}
 
-  uint8_t previous_sw_state = GPIO_PIN_4;
-  uint8_t debounce_sw_state = GPIO_PIN_4;
-  uint8_t current_sw_state = GPIO_PIN_4;
+/**
+ * @brief Interrupt handler for the board link UART
+ */
+void boardUartISR(void)
+{
+  MAP_UARTIntClear(BOARD_UART, MAP_UARTIntStatus(BOARD_UART, true));
+  event_post(EVENT_BOARD_RX);
+}
 
-  // Infinite loop for polling UART
-  while (true)
+/**
+ * @brief Interrupt handler for SW1
+ *
+ * Acts on the first press edge, so debouncing adds no latency, then ignores
+ * the switch until the debounce timer sees it settled released. Bounces on
+ * the press and on the release never post a second press.
+ */
+void sw1ISR(void)
+{
+  MAP_GPIOIntClear(GPIO_PORTF_BASE, GPIO_INT_PIN_4);
+  MAP_GPIOIntDisable(GPIO_PORTF_BASE, GPIO_INT_PIN_4);
+
+  sw1_press_time = timing_now();
+  event_post(EVENT_SW1);
+
+  sw1_released = false;
+  MAP_TimerLoadSet(SW1_DEBOUNCE_TIMER_BASE, TIMER_A, SW1_DEBOUNCE_TICKS);
+  MAP_TimerEnable(SW1_DEBOUNCE_TIMER_BASE, TIMER_A);
+}
+
+/**
+ * @brief Interrupt handler for the SW1 debounce timer
+ *
+ * Checks the switch every SW1_DEBOUNCE_TICKS while it is held, and listens
+ * for the next press edge once it has read released at two checks in a row.
+ */
+void sw1DebounceISR(void)
+{
+  bool released;
+
+  MAP_TimerIntClear(SW1_DEBOUNCE_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+  released = MAP_GPIOPinRead(GPIO_PORTF_BASE, GPIO_PIN_4) != 0;
+  if (!(released && sw1_released))
   {
+    sw1_released = released;
+    MAP_TimerLoadSet(SW1_DEBOUNCE_TIMER_BASE, TIMER_A, SW1_DEBOUNCE_TICKS);
+    MAP_TimerEnable(SW1_DEBOUNCE_TIMER_BASE, TIMER_A);
+    return;
+  }
 
-    // Non blocking UART polling
-    if (uart_avail(HOST_UART))
+  MAP_GPIOIntClear(GPIO_PORTF_BASE, GPIO_INT_PIN_4);
+  MAP_GPIOIntEnable(GPIO_PORTF_BASE, GPIO_INT_PIN_4);
+}
+
+/**
+ * @brief Event handler that assembles and runs host commands
+ *
+ * Consumes every byte available, so bytes that arrive while a command runs
+ * are picked up by the next EVENT_HOST_RX.
+ */
+void handleHostRx(void)
+{
+  while (uart_avail(HOST_UART))
+  {
+    uint8_t uart_char = (uint8_t)uart_readb(HOST_UART);
+
+    if ((uart_char != '\r') && (uart_char != '\n') && (uart_char != '\0') &&
+        (uart_char != 0xD))
+    {
+      uart_buffer[uart_buffer_index] = uart_char;
+      uart_buffer_index++;
+    }
+    else
     {
-      uint8_t uart_char = (uint8_t)uart_readb(HOST_UART);
+      uart_buffer[uart_buffer_index] = 0x00;
+      uart_buffer_index = 0;
 
-      if ((uart_char != '\r') && (uart_char != '\n') && (uart_char != '\0') &&
-          (uart_char != 0xD))
+      if (!(strcmp((char *)uart_buffer, "enable")))
       {
-        uart_buffer[uart_buffer_index] = uart_char;
-        uart_buffer_index++;
+        enableFeature(&fob_state_ram);
       }
-      else
+      else if (!(strcmp((char *)uart_buffer, "enable_batch")))
       {
-        uart_buffer[uart_buffer_index] = 0x00;
-        uart_buffer_index = 0;
-
-        if (!(strcmp((char *)uart_buffer, "enable")))
-        {
-          enableFeature(&fob_state_ram);
-        }
-        else if (!(strcmp((char *)uart_buffer, "pair")))
-        {
-          pairFob(&fob_state_ram);
-        }
+        enableFeatureBatch(&fob_state_ram);
       }
-    }
-
-    current_sw_state = GPIOPinRead(GPIO_PORTF_BASE, GPIO_PIN_4);
-    if ((current_sw_state != previous_sw_state) && (current_sw_state == 0))
-    {
-      // Debounce switch
-      for (int i = 0; i < 10000; i++)
-        ;
-      debounce_sw_state = GPIOPinRead(GPIO_PORTF_BASE, GPIO_PIN_4);
-      if (debounce_sw_state == current_sw_state)
+      else if (!(strcmp((char *)uart_buffer, "pair")))
+      {
+        pairFob(&fob_state_ram);
+      }
+      else if (!(strcmp((char *)uart_buffer, "timing")))
       {
-        unlockCar(&fob_state_ram);
-        if (receiveAck())
-        {
-          startCar(&fob_state_ram);
-        }
+        reportTiming();
+      }
+      else if (!(strcmp((char *)uart_buffer, "stack")))
+      {
+        reportStack();
       }
     }
-    previous_sw_state = current_sw_state;
   }
 }
 
+/**
+ * @brief Event handler for a press of SW1
+ */
+void handleSw1(void)
+{
+  unlockCar(&fob_state_ram);
+  timing_stats.sw1_unlock_us = timing_elapsed_us(sw1_press_time);
+  timing_stats.wake_unlock_us = timing_elapsed_us(event_wake_time());
+
+  if (receiveAck())
+  {
+    startCar(&fob_state_ram);
+  }
+}
+
+/**
+ * @brief Function that sends the recorded latencies to the host
+ *
+ * Replies with "Timing" followed by the TIMING_STATS words.
+ */
+void reportTiming(void)
+{
+  uart_write(HOST_UART, (uint8_t *)"Timing", 6);
+  uart_write(HOST_UART, (uint8_t *)&timing_stats, sizeof(timing_stats));
+}
+
+/**
+ * @brief Function that sends the stack high-water mark to the host
+ *
+ * Replies with "Stack" followed by the most stack used since boot, in bytes,
+ * as a little-endian word.
+ */
+void reportStack(void)
+{
+  uint32_t used = StackHighWaterMark();
+
+  uart_write(HOST_UART, (uint8_t *)"Stack", 5);
+  uart_write(HOST_UART, (uint8_t *)&used, sizeof(used));
+}
+
 /**
  * @brief Function that carries out pairing of the fob
  *
+ * Each stage is reported to the host so pair_tool can wait on events
+ * rather than fixed delays. The paired fob writes "P" when it is ready for
+ * the pin, then "A" once the pair packet is sent or "X" if the pin was
+ * rejected. The unpaired fob writes "P" when it is waiting for the pair
+ * packet, "R" once it arrives and "Paired" once it is saved.
+ *
  * @param fob_state_ram pointer to the current fob state in ram
  */
 void pairFob(FLASH_DATA *fob_state_ram)
@@ -239,15 +459,15 @@ void pairFob(FLASH_DATA *fob_state_ram)
   if (fob_state_ram->paired == FLASH_PAIRED)
   {
     int16_t bytes_read;
-    uint8_t uart_buffer[8];
+    uint32_t pin_buffer[PAIR_PIN_SIZE / sizeof(uint32_t)] = {0};
     uart_write(HOST_UART, (uint8_t *)"P", 1);
-    bytes_read = uart_readline(HOST_UART, uart_buffer);
+    bytes_read = uart_readline(HOST_UART, (uint8_t *)pin_buffer);
 
     if (bytes_read == 6)
     {
-      // If the pin is correct
-      if (!(strcmp((char *)uart_buffer,
-                   (char *)fob_state_ram->pair_info.pin)))
+      // If the pin is correct - both sides are zero padded to whole words
+      if (!ct_compare(pin_buffer, fob_state_ram->pair_info.pin,
+                      PAIR_PIN_SIZE))
       {
         // Pair the new key by sending a PAIR_PACKET structure
         // with required information to unlock door
@@ -255,22 +475,29 @@ void pairFob(FLASH_DATA *fob_state_ram)
         message.magic = PAIR_MAGIC;
         message.buffer = (uint8_t *)&fob_state_ram->pair_info;
         send_board_message(&message);
+        uart_write(HOST_UART, (uint8_t *)"A", 1);
+        return;
       }
     }
+
+    uart_write(HOST_UART, (uint8_t *)"X", 1);
   }
 
   // Start pairing transaction - fob is not paired
   else
   {
+    uart_write(HOST_UART, (uint8_t *)"P", 1);
     message.buffer = (uint8_t *)&fob_state_ram->pair_info;
     receive_board_message_by_type(&message, PAIR_MAGIC);
-    fob_state_ram->paired = FLASH_PAIRED;
-    strcpy((char *)fob_state_ram->feature_info.car_id,
-           (char *)fob_state_ram->pair_info.car_id);
+    uart_write(HOST_UART, (uint8_t *)"R", 1);
 
-    uart_write(HOST_UART, (uint8_t *)"Paired", 6);
+    fob_state_ram->paired = FLASH_PAIRED;
+    ct_copy(fob_state_ram->feature_info.car_id,
+            fob_state_ram->pair_info.car_id,
+            sizeof(fob_state_ram->feature_info.car_id));
 
     saveFobState(fob_state_ram);
+    uart_write(HOST_UART, (uint8_t *)"Paired", 6);
   }
 }
 
@@ -283,38 +510,69 @@ void enableFeature(FLASH_DATA *fob_state_ram)
 {
   if (fob_state_ram->paired == FLASH_PAIRED)
   {
-    uint8_t uart_buffer[20];
+    uint8_t uart_buffer[20] __attribute__((aligned(4)));
     uart_readline(HOST_UART, uart_buffer);
 
     ENABLE_PACKET *enable_message = (ENABLE_PACKET *)uart_buffer;
-    if (strcmp((char *)fob_state_ram->pair_info.car_id,
-               (char *)enable_message->car_id))
+    if (applyEnable(fob_state_ram, enable_message) != ENABLE_OK)
     {
       return;
     }
 
-    // Feature list full
-    if (fob_state_ram->feature_info.num_active == NUM_FEATURES)
-    {
-      return;
-    }
+    saveFobState(fob_state_ram);
+    uart_write(HOST_UART, (uint8_t *)"Enabled", 7);
+  }
+}
+
+/**
+ * @brief Function that handles enabling several features in one session
+ *
+ * Reads enable packages one per line until an empty line, applies them to
+ * the state in ram and saves flash once at the end. Replies with "Enabled",
+ * the number of packages applied, and one status byte per package.
+ *
+ * @param fob_state_ram pointer to the current fob state in ram
+ */
+void enableFeatureBatch(FLASH_DATA *fob_state_ram)
+{
+  if (fob_state_ram->paired == FLASH_PAIRED)
+  {
+    uint8_t uart_buffer[20] __attribute__((aligned(4)));
+    uint8_t status[ENABLE_BATCH_MAX];
+    uint8_t count = 0;
+    bool changed = false;
+    uint32_t bytes_read;
 
-    // Search for feature in list
-    for (int i = 0; i < fob_state_ram->feature_info.num_active; i++)
+    while ((bytes_read = uart_readline(HOST_UART, uart_buffer)) != 0)
     {
-      if (fob_state_ram->feature_info.features[i] == enable_message->feature)
+      // Packages past the limit are read and dropped
+      if (count == ENABLE_BATCH_MAX)
       {
-        return;
+        continue;
+      }
+
+      if (bytes_read != CAR_ID_SIZE + 1)
+      {
+        status[count] = ENABLE_BAD_PACKET;
+      }
+      else
+      {
+        status[count] =
+            applyEnable(fob_state_ram, (ENABLE_PACKET *)uart_buffer);
       }
+
+      changed |= (status[count] == ENABLE_OK);
+      count++;
     }
 
-    fob_state_ram->feature_info
-        .features[fob_state_ram->feature_info.num_active] =
-        enable_message->feature;
-    fob_state_ram->feature_info.num_active++;
+    if (changed)
+    {
+      saveFobState(fob_state_ram);
+    }
 
-    saveFobState(fob_state_ram);
     uart_write(HOST_UART, (uint8_t *)"Enabled", 7);
+    uart_write(HOST_UART, &count, 1);
+    uart_write(HOST_UART, status, count);
   }
 }
 
@@ -328,9 +586,9 @@ void unlockCar(FLASH_DATA *fob_state_ram)
   if (fob_state_ram->paired == FLASH_PAIRED)
   {
     MESSAGE_PACKET message;
-    message.message_len = 6;
+    message.message_len = PASSWORD_SIZE;
     message.magic = UNLOCK_MAGIC;
-    message.buffer = fob_state_ram->pair_info.password;
+    message.buffer = (uint8_t *)fob_state_ram->pair_info.password;
     send_board_message(&message);
   }
 }
@@ -359,8 +617,47 @@ void startCar(FLASH_DATA *fob_state_ram)
  */
 void saveFobState(FLASH_DATA *flash_data)
 {
-  FlashErase(FOB_STATE_PTR);
-  FlashProgram((uint32_t *)flash_data, FOB_STATE_PTR, FLASH_DATA_SIZE);
+  MAP_FlashErase(FOB_STATE_PTR);
+  MAP_FlashProgram((uint32_t *)flash_data, FOB_STATE_PTR, FLASH_DATA_SIZE);
+}
+
+/**
+ * @brief Function that adds a feature from an enable package to the state
+ * in ram without saving it
+ *
+ * @param fob_state_ram pointer to the current fob state in ram
+ * @param enable_message pointer to the received enable package
+ * @return uint8_t ENABLE_OK if the feature was added, otherwise the reason
+ */
+uint8_t applyEnable(FLASH_DATA *fob_state_ram, ENABLE_PACKET *enable_message)
+{
+  if (ct_compare(fob_state_ram->pair_info.car_id, enable_message->car_id,
+                 CAR_ID_SIZE))
+  {
+    return ENABLE_WRONG_CAR;
+  }
+
+  // Search for feature in list
+  for (int i = 0; i < fob_state_ram->feature_info.num_active; i++)
+  {
+    if (fob_state_ram->feature_info.features[i] == enable_message->feature)
+    {
+      return ENABLE_DUPLICATE;
+    }
+  }
+
+  // Feature list full
+  if (fob_state_ram->feature_info.num_active == NUM_FEATURES)
+  {
+    return ENABLE_FULL;
+  }
+
+  fob_state_ram->feature_info
+      .features[fob_state_ram->feature_info.num_active] =
+      enable_message->feature;
+  fob_state_ram->feature_info.num_active++;
+
+  return ENABLE_OK;
 }
 
 /**
@@ -372,9 +669,11 @@ void saveFobState(FLASH_DATA *flash_data)
 uint8_t receiveAck()
 {
   MESSAGE_PACKET message;
-  uint8_t buffer[255];
-  message.buffer = buffer;
+  message.buffer = message_buffer_alloc();
   receive_board_message_by_type(&message, ACK_MAGIC);
 
-  return message.buffer[0];
+  uint8_t ack = message.buffer[0];
+  message_buffer_release(message.buffer);
+
+  return ack;
 }
@@ -0,0 +1,74 @@
+/**
+ * @file timing.c
+ * @brief Free-running timestamp counter and recorded latencies
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+
+#include "driverlib_map.h"
+#include "timing.h"
+
+#define TIMING_TIMER_BASE TIMER2_BASE
+
+// DWT cycle counter, started from zero by Firmware_Startup
+#define DWT_CYCCNT 0xE0001004
+
+TIMING_STATS timing_stats;
+
+/**
+ * @brief Start the free-running timestamp counter
+ */
+void timing_init(void) {
+  while (!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER2)) {
+  }
+
+  MAP_TimerClockSourceSet(TIMING_TIMER_BASE, TIMER_CLOCK_PIOSC);
+  MAP_TimerConfigure(TIMING_TIMER_BASE, TIMER_CFG_PERIODIC);
+  MAP_TimerLoadSet(TIMING_TIMER_BASE, TIMER_A, 0xFFFFFFFF);
+  MAP_TimerEnable(TIMING_TIMER_BASE, TIMER_A);
+}
+
+/**
+ * @brief Read the current timestamp
+ *
+ * @return the timestamp in ticks, counting up
+ */
+uint32_t timing_now(void) {
+  // The timer counts down, so invert it to get an increasing count
+  return ~MAP_TimerValueGet(TIMING_TIMER_BASE, TIMER_A);
+}
+
+/**
+ * @brief Time elapsed since a timestamp
+ *
+ * @param start timestamp returned by timing_now()
+ * @return the elapsed time in microseconds
+ */
+uint32_t timing_elapsed_us(uint32_t start) {
+  // Unsigned subtraction handles a single wrap of the counter
+  return (timing_now() - start) / TIMING_TICKS_PER_US;
+}
+
+/**
+ * @brief Time elapsed since reset
+ *
+ * @return the elapsed time in microseconds
+ */
+uint32_t timing_since_reset_us(void) {
+  return HWREG(DWT_CYCCNT) / (MAP_SysCtlClockGet() / 1000000);
+}
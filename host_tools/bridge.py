@@ -0,0 +1,47 @@
+# @file bridge.py
+# @brief helper for connecting host tools to a device bridge
+# @date 2023
+#
+# This source file is part of an example system for MITRE's 2023 Embedded
+# CTF (eCTF). This code is being provided only for educational purposes for the
+# 2023 MITRE eCTF competition, and may not meet MITRE standards for quality.
+# Use this code at your own risk!
+#
+# @copyright Copyright (c) 2023 The MITRE Corporation
+
+import os
+import json
+import asyncio
+
+# Unix socket of the bridge daemon - overridden by ECTF_BRIDGE_DAEMON
+DEFAULT_DAEMON_SOCKET = "/tmp/ectf_bridge.sock"
+
+
+# @brief Path of the bridge daemon socket
+def daemon_socket():
+    return os.environ.get("ECTF_BRIDGE_DAEMON", DEFAULT_DAEMON_SOCKET)
+
+
+# @brief Open an asyncio stream connection to a device bridge
+#
+# Goes through the bridge daemon when it is running, which keeps the bridge
+# connection open between tool invocations. Otherwise connects directly.
+# @param bridge, port number of the bridge on ectf-net
+async def open_connection(bridge):
+    path = daemon_socket()
+
+    if os.path.exists(path):
+        try:
+            reader, writer = await asyncio.open_unix_connection(path)
+        except OSError:
+            # Stale socket file - daemon is not running
+            pass
+        else:
+            writer.write(json.dumps({"bridge": int(bridge)}).encode() + b"\n")
+            reply = await reader.readline()
+            if reply != b"OK\n":
+                writer.close()
+                raise ConnectionError(f"Bridge daemon: {reply.decode().strip()}")
+            return reader, writer
+
+    return await asyncio.open_connection("ectf-net", int(bridge))
@@ -0,0 +1,197 @@
+# @file protocol.py
+# @brief host side of the fob and car serial protocols, shared by the host tools
+# @date 2023
+#
+# This source file is part of an example system for MITRE's 2023 Embedded
+# CTF (eCTF). This code is being provided only for educational purposes for the
+# 2023 MITRE eCTF competition, and may not meet MITRE standards for quality.
+# Use this code at your own risk!
+#
+# @copyright Copyright (c) 2023 The MITRE Corporation
+
+import asyncio
+
+import bridge
+from session import Session
+
+# Framing of the car's unlock response - must match car/src/firmware.c
+#   'U' flags [nonce] unlock_message 'F' num_features features... [tag]
+RESPONSE_UNLOCK_MAGIC = b"U"
+RESPONSE_FEATURE_MAGIC = b"F"
+RESPONSE_FLAG_AEAD = 0x01
+UNLOCK_MESSAGE_SIZE = 64
+FEATURE_SIZE = 64
+SESSION_NONCE_SIZE = 16
+SESSION_TAG_SIZE = 16
+
+# Fob replies to the host - must match fob/src/firmware.c
+PAIR_PROMPT = b"P"
+PIN_ACCEPTED = b"A"
+PIN_REJECTED = b"X"
+PAIR_RECEIVED = b"R"
+PAIRED = b"Paired"
+ENABLED = b"Enabled"
+
+# Must match ENABLE_BATCH_MAX and the ENABLE_* status codes in fob/src/firmware.c
+ENABLE_BATCH_MAX = 32
+ENABLE_OK = 0x00
+ENABLE_ALREADY = 0x01
+ENABLE_STATUS = {
+    ENABLE_OK: "enabled",
+    ENABLE_ALREADY: "already enabled",
+    0x02: "wrong car",
+    0x03: "feature list full",
+    0x04: "bad package",
+}
+
+
+# @brief A device answered with something the protocol does not allow
+class ProtocolError(Exception):
+    pass
+
+
+# @brief Connection to one device through its bridge
+#
+# Replies are found by resyncing on their magic: bytes in front of the
+# expected reply (debug output, or the tail of an earlier session) are
+# discarded, so one stray byte does not fail the operation.
+class Device:
+    # @param reader, asyncio stream reader of the bridge connection
+    # @param writer, asyncio stream writer of the bridge connection
+    def __init__(self, reader, writer):
+        self.reader = reader
+        self.writer = writer
+        self.buffer = bytearray()
+
+    # @brief Connect to a device bridge
+    # @param port, port number of the bridge
+    @classmethod
+    async def open(cls, port):
+        return cls(*await bridge.open_connection(port))
+
+    # @brief Close the bridge connection
+    def close(self):
+        self.writer.close()
+
+    # @brief Send bytes to the device
+    # @param data, bytes to send
+    async def send(self, data):
+        self.writer.write(data)
+        await self.writer.drain()
+
+    # @brief Read more device output into the buffer
+    async def fill(self):
+        data = await self.reader.read(4096)
+        if not data:
+            raise ConnectionError("bridge closed the connection")
+        self.buffer += data
+
+    # @brief Read exactly n bytes
+    # @param n, number of bytes to read
+    async def read(self, n):
+        while len(self.buffer) < n:
+            await self.fill()
+        data = bytes(self.buffer[:n])
+        del self.buffer[:n]
+        return data
+
+    # @brief Wait for one of the expected replies, discarding what precedes it
+    # @param options, accepted replies - the earliest in the output wins
+    # @return the reply received
+    async def expect(self, *options):
+        while True:
+            found = [(self.buffer.find(o), o) for o in options if o in self.buffer]
+            if found:
+                index, option = min(found)
+                del self.buffer[: index + len(option)]
+                return option
+            await self.fill()
+
+
+# @brief Pair an unpaired fob through a paired fob
+#
+# Not idempotent - once the unpaired fob has saved the pair packet it is no
+# longer unpaired, so a failed attempt must not be blindly repeated.
+# @param unpaired, Device of the unpaired fob
+# @param paired, Device of the paired fob
+# @param pair_pin, pin of the paired fob
+# @param mark, called with the name of each stage as it is reached
+async def pair(unpaired, paired, pair_pin, mark=lambda stage: None):
+    await asyncio.gather(unpaired.send(b"pair\n"), paired.send(b"pair\n"))
+
+    # Both fobs are ready - the paired fob prompts for the pin and the
+    # unpaired fob is waiting for the pair packet
+    await asyncio.gather(paired.expect(PAIR_PROMPT), unpaired.expect(PAIR_PROMPT))
+    mark("prompt")
+
+    await paired.send(pair_pin.encode() + b"\n")
+    if await paired.expect(PIN_ACCEPTED, PIN_REJECTED) != PIN_ACCEPTED:
+        raise ProtocolError("pin rejected")
+    mark("pin accepted")
+
+    # Wait for the unpaired fob to receive and save the pair packet
+    await unpaired.expect(PAIR_RECEIVED)
+    mark("packet received")
+    await unpaired.expect(PAIRED)
+    mark("paired written")
+
+
+# @brief Enable one package with the single-package enable command
+#
+# The fob replies only on success - a failure shows as a timeout.
+# @param fob, Device of the fob
+# @param package, package data
+async def enable(fob, package):
+    await fob.send(b"enable\n" + package)
+    await fob.expect(ENABLED)
+
+
+# @brief Enable several packages in one fob session
+#
+# The fob applies every package and saves flash once, then replies with
+# "Enabled", the package count and one status byte per package.
+# @param fob, Device of the fob
+# @param packages, list of package data, at most ENABLE_BATCH_MAX
+# @return list of status codes, one per package
+async def enable_batch(fob, packages):
+    # Packages are sent one per line and ended with an empty line
+    await fob.send(b"enable_batch\n" + b"".join(packages) + b"\n")
+    await fob.expect(ENABLED)
+    count = (await fob.read(1))[0]
+    if count != len(packages):
+        raise ProtocolError(f"fob reported {count} of {len(packages)} packages")
+    return list(await fob.read(count))
+
+
+# @brief Read a car's framed unlock response
+#
+# A SESSION_AEAD response is verified and decrypted when the car's session
+# root key is given, and returned as received otherwise.
+# @param car, Device of the car
+# @param key, session root key of the car, or None
+# @return (unlock message, features, whether the response was encrypted)
+async def unlock(car, key=None):
+    await car.expect(RESPONSE_UNLOCK_MAGIC)
+    flags = (await car.read(1))[0]
+    aead = bool(flags & RESPONSE_FLAG_AEAD)
+    session = None
+    if aead and key is not None:
+        session = Session(key, await car.read(SESSION_NONCE_SIZE))
+        session.authenticate(RESPONSE_UNLOCK_MAGIC + bytes([flags]))
+    elif aead:
+        await car.read(SESSION_NONCE_SIZE)
+    unlock_message = await car.read(UNLOCK_MESSAGE_SIZE)
+
+    await car.expect(RESPONSE_FEATURE_MAGIC)
+    num_features = (await car.read(1))[0]
+    features = await car.read(num_features * FEATURE_SIZE)
+    tag = await car.read(SESSION_TAG_SIZE) if aead else None
+
+    if session:
+        unlock_message = session.decrypt(unlock_message)
+        session.authenticate(RESPONSE_FEATURE_MAGIC + bytes([num_features]))
+        features = session.decrypt(features)
+        if not session.verify(tag):
+            raise ProtocolError("response failed authentication")
+
+    return unlock_message, features, aead
@@ -0,0 +1,178 @@
+# @file session.py
+# @brief helper for verifying and decrypting the car's SESSION_AEAD response
+# @date 2023
+#
+# This source file is part of an example system for MITRE's 2023 Embedded
+# CTF (eCTF). This code is being provided only for educational purposes for the
+# 2023 MITRE eCTF competition, and may not meet MITRE standards for quality.
+# Use this code at your own risk!
+#
+# @copyright Copyright (c) 2023 The MITRE Corporation
+
+import hmac
+import json
+
+# Must match car/src/session.c
+SESSION_INFO = b"ectf-car-session"
+BLOCK_SIZE = 16
+
+
+# @brief Rotate a byte left
+def _rotl8(x, n):
+    return ((x << n) | (x >> (8 - n))) & 0xFF
+
+
+# @brief Build the AES S-box
+#
+# Multiplicative inverse in GF(2^8) followed by the affine transform, walking
+# the field with generator 3 so both come from one loop.
+def _make_sbox():
+    sbox = [0x63] * 256
+    p = q = 1
+    while True:
+        # p *= 3, q /= 3
+        p ^= ((p << 1) ^ (0x1B if p & 0x80 else 0)) & 0xFF
+        q ^= q << 1
+        q ^= q << 2
+        q ^= q << 4
+        q &= 0xFF
+        if q & 0x80:
+            q ^= 0x09
+        affine = q ^ _rotl8(q, 1) ^ _rotl8(q, 2) ^ _rotl8(q, 3) ^ _rotl8(q, 4)
+        sbox[p] = affine ^ 0x63
+        if p == 1:
+            return sbox
+
+
+SBOX = _make_sbox()
+
+
+# @brief Multiply by x in GF(2^8)
+def _xtime(b):
+    return ((b << 1) ^ 0x1B) & 0xFF if b & 0x80 else b << 1
+
+
+# @brief AES-128 forward cipher
+#
+# CTR and CMAC only ever encrypt, so the inverse cipher is left out. The host
+# tools have no third-party dependencies, and a few blocks per unlock do not
+# need a fast implementation.
+class AES128:
+    # @param key, 16 byte key
+    def __init__(self, key):
+        if len(key) != 16:
+            raise ValueError("AES-128 needs a 16 byte key")
+        words = [list(key[i : i + 4]) for i in range(0, 16, 4)]
+        rcon = 1
+        for i in range(4, 44):
+            word = list(words[i - 1])
+            if i % 4 == 0:
+                word = [SBOX[b] for b in word[1:] + word[:1]]
+                word[0] ^= rcon
+                rcon = _xtime(rcon)
+            words.append([a ^ b for a, b in zip(words[i - 4], word)])
+        self.round_keys = [sum(words[r * 4 : r * 4 + 4], []) for r in range(11)]
+
+    # @brief Encrypt one block
+    # @param block, 16 bytes of plaintext
+    def encrypt_block(self, block):
+        state = [a ^ b for a, b in zip(block, self.round_keys[0])]
+        for rnd in range(1, 11):
+            # SubBytes and ShiftRows - the state is column-major
+            state = [SBOX[state[(i + 4 * (i % 4)) % 16]] for i in range(16)]
+            if rnd != 10:
+                mixed = []
+                for c in range(0, 16, 4):
+                    a = state[c : c + 4]
+                    t = a[0] ^ a[1] ^ a[2] ^ a[3]
+                    mixed += [
+                        a[i] ^ t ^ _xtime(a[i] ^ a[(i + 1) % 4]) for i in range(4)
+                    ]
+                state = mixed
+            state = [a ^ b for a, b in zip(state, self.round_keys[rnd])]
+        return bytes(state)
+
+
+# @brief Multiply a block by x in GF(2^128) for the CMAC subkeys
+def _double(block):
+    value = int.from_bytes(block, "big") << 1
+    if value >> 128:
+        value ^= (1 << 128) | 0x87
+    return value.to_bytes(BLOCK_SIZE, "big")
+
+
+# @brief AES-CMAC (RFC 4493)
+# @param key, 16 byte key
+# @param data, message bytes
+def cmac(key, data):
+    cipher = AES128(key)
+    k1 = _double(cipher.encrypt_block(bytes(BLOCK_SIZE)))
+    k2 = _double(k1)
+
+    blocks = [data[i : i + BLOCK_SIZE] for i in range(0, len(data), BLOCK_SIZE)]
+    if blocks and len(blocks[-1]) == BLOCK_SIZE:
+        last = bytes(a ^ b for a, b in zip(blocks.pop(), k1))
+    else:
+        partial = blocks.pop() if blocks else b""
+        padded = partial + b"\x80" + bytes(BLOCK_SIZE - len(partial) - 1)
+        last = bytes(a ^ b for a, b in zip(padded, k2))
+
+    x = bytes(BLOCK_SIZE)
+    for block in blocks + [last]:
+        x = cipher.encrypt_block(bytes(a ^ b for a, b in zip(x, block)))
+    return x
+
+
+# @brief Load the session root key of a car from the deployment secrets
+# @param secret_file, path of car_secrets.json
+# @param car_id, id of the car
+def root_key(secret_file, car_id):
+    with open(secret_file, "r") as fp:
+        secrets = json.load(fp)
+    try:
+        return bytes.fromhex(secrets["session_keys"][str(car_id)])
+    except KeyError:
+        raise ValueError(f"No session key for car {car_id} in {secret_file}")
+
+
+# @brief Receiver side of one SESSION_AEAD unlock response
+#
+# Mirrors session_begin(), session_authenticate(), session_encrypt() and
+# session_finish() of the car: the MAC covers the nonce, the clear-text
+# framing headers and the ciphertext in the order the car sent them.
+class Session:
+    # @param key, the car's session root key
+    # @param nonce, nonce sent at the start of the response
+    def __init__(self, key, nonce):
+        # Extract, then expand into the encryption and MAC keys
+        prk = cmac(nonce, key)
+        enc_key = cmac(prk, SESSION_INFO + b"\x01")
+        self.mac_key = cmac(prk, enc_key + SESSION_INFO + b"\x02")
+
+        self.cipher = AES128(enc_key)
+        self.counter = 0
+        self.mac_data = bytearray(nonce)
+
+    # @brief Absorb clear-text data into the MAC
+    # @param data, bytes sent in the clear
+    def authenticate(self, data):
+        self.mac_data += data
+
+    # @brief Absorb one encrypted part of the response and decrypt it
+    #
+    # Like the car, each part starts at the next unused counter block.
+    # @param data, ciphertext of the part
+    def decrypt(self, data):
+        self.mac_data += data
+        stream = b""
+        while len(stream) < len(data):
+            block = self.counter.to_bytes(BLOCK_SIZE, "big")
+            stream += self.cipher.encrypt_block(block)
+            self.counter += 1
+        return bytes(a ^ b for a, b in zip(data, stream))
+
+    # @brief Check the tag that ends the response
+    # @param tag, tag sent by the car
+    # @return True if the tag matches everything absorbed
+    def verify(self, tag):
+        return hmac.compare_digest(cmac(self.mac_key, bytes(self.mac_data)), tag)
@@ -0,0 +1,97 @@
+/**
+ * @file crc_bench.c
+ * @brief Measure host throughput of the sw_crc kernels from 8 B to 2 KB
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "driverlib/sw_crc.h"
+
+// Bytes hashed per measurement, whatever the buffer size
+#define TOTAL_BYTES (64u << 20)
+
+typedef uint32_t (*KERNEL)(uint32_t crc, const uint8_t *data, uint32_t count);
+
+// Crc16 kernels take and return a uint16_t - wrap them to share the loop
+static uint32_t crc16(uint32_t crc, const uint8_t *data, uint32_t count) {
+  return Crc16(crc, data, count);
+}
+static uint32_t crc16_slice4(uint32_t crc, const uint8_t *data,
+                             uint32_t count) {
+  return Crc16Slice4(crc, data, count);
+}
+static uint32_t crc16_slice8(uint32_t crc, const uint8_t *data,
+                             uint32_t count) {
+  return Crc16Slice8(crc, data, count);
+}
+
+static const struct {
+  const char *name;
+  KERNEL kernel;
+} kernels[] = {
+    {"Crc16", crc16},
+    {"Crc16Slice4", crc16_slice4},
+    {"Crc16Slice8", crc16_slice8},
+    {"Crc32", Crc32},
+    {"Crc32Slice4", Crc32Slice4},
+    {"Crc32Slice8", Crc32Slice8},
+};
+
+static const uint32_t sizes[] = {8, 16, 32, 64, 128, 256, 512, 1024, 2048};
+
+/**
+ * @brief Time one kernel on one buffer size
+ *
+ * @return throughput in MB/s
+ */
+static double measure(KERNEL kernel, const uint8_t *data, uint32_t size) {
+  struct timespec start, end;
+  volatile uint32_t sink;
+  uint32_t crc = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t done = 0; done < TOTAL_BYTES; done += size) {
+    crc = kernel(crc, data, size);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  sink = crc;
+  (void)sink;
+
+  double seconds =
+      (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  return TOTAL_BYTES / seconds / 1e6;
+}
+
+int main(void) {
+  static uint32_t words[2048 / sizeof(uint32_t)];
+  const uint8_t *data = (const uint8_t *)words;
+
+  for (uint32_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+    words[i] = i * 0x9e3779b9;
+  }
+
+  printf("%-8s", "size");
+  for (uint32_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+    printf("%13s", kernels[k].name);
+  }
+  printf("   (MB/s)\n");
+
+  for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    printf("%-8u", sizes[s]);
+    for (uint32_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+      printf("%13.0f", measure(kernels[k].kernel, data, sizes[s]));
+    }
+    printf("\n");
+  }
+  return 0;
+}
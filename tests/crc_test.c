@@ -0,0 +1,94 @@
+/**
+ * @file crc_test.c
+ * @brief Check the sliced sw_crc kernels against the byte-wise ones
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "driverlib/sw_crc.h"
+
+#define MAX_LEN 600
+#define OFFSETS 8
+
+static int failures = 0;
+
+/**
+ * @brief Report a mismatch between a kernel and its reference
+ */
+static void check(const char *kernel, uint32_t got, uint32_t want,
+                  uint32_t len, uint32_t offset) {
+  if (got != want) {
+    printf("FAIL %s len %u offset %u: 0x%08x != 0x%08x\n", kernel, len, offset,
+           got, want);
+    failures++;
+  }
+}
+
+int main(void) {
+  static uint8_t buffer[MAX_LEN + OFFSETS];
+  const uint8_t check_string[] = "123456789";
+  uint32_t crc32;
+
+  srand(2023);
+  for (uint32_t i = 0; i < sizeof(buffer); i++) {
+    buffer[i] = rand();
+  }
+
+  // Known answer: the standard CRC-32 check value
+  crc32 = Crc32(0xffffffff, check_string, 9) ^ 0xffffffff;
+  check("Crc32", crc32, 0xcbf43926, 9, 0);
+  crc32 = Crc32Slice8(0xffffffff, check_string, 9) ^ 0xffffffff;
+  check("Crc32Slice8", crc32, 0xcbf43926, 9, 0);
+
+  // Empty input leaves the running value alone
+  check("Crc16Slice8 empty", Crc16Slice8(0x1234, buffer + 1, 0), 0x1234, 0, 1);
+  check("Crc32Slice8 empty", Crc32Slice8(0x12345678, buffer + 1, 0), 0x12345678,
+        0, 1);
+
+  // Every length at every alignment, with a random running value. The
+  // reference Crc16() underruns its count on an empty odd-aligned buffer,
+  // so lengths start at one.
+  for (uint32_t offset = 0; offset < OFFSETS; offset++) {
+    for (uint32_t len = 1; len <= MAX_LEN; len++) {
+      const uint8_t *data = buffer + offset;
+      uint16_t seed16 = rand();
+      uint32_t seed32 = ((uint32_t)rand() << 16) ^ rand();
+      uint16_t want16 = Crc16(seed16, data, len);
+      uint32_t want32 = Crc32(seed32, data, len);
+
+      check("Crc16Slice4", Crc16Slice4(seed16, data, len), want16, len, offset);
+      check("Crc16Slice8", Crc16Slice8(seed16, data, len), want16, len, offset);
+      check("Crc32Slice4", Crc32Slice4(seed32, data, len), want32, len, offset);
+      check("Crc32Slice8", Crc32Slice8(seed32, data, len), want32, len, offset);
+
+      // Running use: split the buffer and feed the halves in turn
+      uint32_t half = len / 2;
+      check("Crc16Slice8 running",
+            Crc16Slice8(Crc16Slice8(seed16, data, half), data + half,
+                        len - half),
+            want16, len, offset);
+      check("Crc32Slice8 running",
+            Crc32Slice8(Crc32Slice8(seed32, data, half), data + half,
+                        len - half),
+            want32, len, offset);
+    }
+  }
+
+  if (failures) {
+    printf("%d failures\n", failures);
+    return 1;
+  }
+  printf("All CRC kernels match, lengths 1..%u at %u offsets\n", MAX_LEN,
+         OFFSETS);
+  return 0;
+}
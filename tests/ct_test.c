@@ -0,0 +1,188 @@
+/**
+ * @file ct_test.c
+ * @brief Check ct_util results and that ct_compare timing ignores the data
+ * @date 2023
+ *
+ * This source file is part of an example system for MITRE's 2023 Embedded
+ * System CTF (eCTF). This code is being provided only for educational purposes
+ * for the 2023 MITRE eCTF competition, and may not meet MITRE standards for
+ * quality. Use this code at your own risk!
+ *
+ * @copyright Copyright (c) 2023 The MITRE Corporation
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ct_util.h"
+
+#define MAX_LEN 256
+#define SAMPLES 200000
+
+// Welch t above this means the two classes take measurably different time
+// (the threshold dudect uses to call an implementation leaky)
+#define T_LIMIT 10.0
+
+// Measurements above this fraction of the sorted samples are dropped as
+// interrupts and other noise unrelated to the code under test
+#define CROP 0.9
+
+typedef uint32_t (*COMPARE)(const void *a, const void *b, uint32_t len);
+
+static int failures = 0;
+
+/**
+ * @brief Report a failed functional check
+ */
+static void expect(int ok, const char *what, uint32_t len, uint32_t offset) {
+  if (!ok) {
+    printf("FAIL %s len %u offset %u\n", what, len, offset);
+    failures++;
+  }
+}
+
+/**
+ * @brief Read a cycle (or failing that, nanosecond) counter
+ */
+static inline uint64_t now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static int by_value(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+// memcmp as a control - it stops at the first difference, so the harness
+// should see it leak
+static uint32_t memcmp_compare(const void *a, const void *b, uint32_t len) {
+  return memcmp(a, b, len) != 0;
+}
+
+/**
+ * @brief Welch's t between equal inputs and inputs that differ at once
+ *
+ * The class of each sample is picked at random so drift in the machine
+ * affects both alike.
+ *
+ * @return t statistic, near zero when timing does not depend on the class
+ */
+static double timing_t(COMPARE compare, uint32_t len) {
+  static uint8_t secret[MAX_LEN], guess[2][MAX_LEN];
+  static uint64_t cycles[SAMPLES], sorted[SAMPLES];
+  static uint8_t classes[SAMPLES];
+  volatile uint32_t sink;
+
+  for (uint32_t i = 0; i < len; i++) {
+    secret[i] = rand();
+    guess[0][i] = secret[i];
+    guess[1][i] = secret[i];
+  }
+  guess[1][0] ^= 1;
+
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    uint8_t class = rand() & 1;
+    uint64_t start = now();
+    sink = compare(secret, guess[class], len);
+    cycles[i] = now() - start;
+    classes[i] = class;
+  }
+  (void)sink;
+
+  memcpy(sorted, cycles, sizeof(sorted));
+  qsort(sorted, SAMPLES, sizeof(sorted[0]), by_value);
+  uint64_t crop = sorted[(uint32_t)(SAMPLES * CROP)];
+
+  double n[2] = {0}, mean[2] = {0}, m2[2] = {0};
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    if (cycles[i] > crop) {
+      continue;
+    }
+    // Welford's running mean and variance
+    uint8_t c = classes[i];
+    double d = cycles[i] - mean[c];
+    n[c]++;
+    mean[c] += d / n[c];
+    m2[c] += d * (cycles[i] - mean[c]);
+  }
+
+  double var0 = m2[0] / (n[0] - 1), var1 = m2[1] / (n[1] - 1);
+  return (mean[0] - mean[1]) / sqrt(var0 / n[0] + var1 / n[1]);
+}
+
+/**
+ * @brief Check results on every length and alignment
+ */
+static void functional(void) {
+  static uint8_t a[MAX_LEN + 4], b[MAX_LEN + 4], c[MAX_LEN + 4];
+
+  for (uint32_t offset = 0; offset < 4; offset++) {
+    for (uint32_t len = 0; len <= MAX_LEN; len++) {
+      for (uint32_t i = 0; i < sizeof(a); i++) {
+        a[i] = b[i] = rand();
+      }
+      uint32_t want = memcmp(a + offset, b, len) != 0;
+      expect(ct_compare(a + offset, b, len) == want, "ct_compare unaligned",
+             len, offset);
+      expect(ct_compare(a + offset, b + offset, len) == 0, "ct_compare equal",
+             len, offset);
+      if (len) {
+        b[offset + len - 1] ^= 0x80;
+        expect(ct_compare(a + offset, b + offset, len) == 1,
+               "ct_compare last byte", len, offset);
+        b[offset] ^= 0x01;
+        expect(ct_compare(a + offset, b + offset, len) == 1,
+               "ct_compare first byte", len, offset);
+      }
+
+      memset(c, 0xa5, sizeof(c));
+      ct_copy(c + offset, a + offset, len);
+      expect(memcmp(c + offset, a + offset, len) == 0, "ct_copy", len, offset);
+      expect(c[offset + len] == 0xa5, "ct_copy overrun", len, offset);
+
+      ct_zeroize(c + offset, len);
+      for (uint32_t i = 0; i < len; i++) {
+        expect(c[offset + i] == 0, "ct_zeroize", len, offset);
+      }
+      expect(c[offset + len] == 0xa5, "ct_zeroize overrun", len, offset);
+    }
+  }
+}
+
+int main(void) {
+  static const uint32_t sizes[] = {8, 64, 256};
+
+  srand(2023);
+  functional();
+
+  printf("Welch t, equal vs differing inputs (|t| > %.0f leaks)\n", T_LIMIT);
+  printf("%-8s%12s%12s\n", "size", "ct_compare", "memcmp");
+  for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    double t = timing_t(ct_compare, sizes[s]);
+    double control = timing_t(memcmp_compare, sizes[s]);
+
+    printf("%-8u%12.1f%12.1f\n", sizes[s], t, control);
+    if (fabs(t) > T_LIMIT) {
+      printf("FAIL ct_compare timing depends on the data at %u bytes\n",
+             sizes[s]);
+      failures++;
+    }
+  }
+
+  if (failures) {
+    printf("%d failures\n", failures);
+    return 1;
+  }
+  printf("ct_util checks passed\n");
+  return 0;
+}